@@ -0,0 +1,184 @@
+#include "genesis/memory.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t element_counts[] = {1'000, 100'000, 1'000'000};
+constexpr std::size_t total_elements = 4'000'000;
+constexpr std::size_t bulk_elements = 1 << 20;
+constexpr std::size_t bulk_rounds = 200;
+
+/// @brief A string that always keeps its characters on the heap, so unlike std::string it is trivially relocatable.
+class heap_string {
+private:
+	char* data_;
+	std::size_t size_;
+
+public:
+	explicit heap_string(const char* init) :
+		data_{new char[std::strlen(init) + 1]},
+		size_{std::strlen(init)}
+	{
+		std::memcpy(data_, init, size_ + 1);
+	}
+
+	heap_string(heap_string&& other) noexcept :
+		data_{std::exchange(other.data_, nullptr)},
+		size_{std::exchange(other.size_, 0)}
+	{ }
+
+	heap_string& operator=(heap_string&&) = delete;
+
+	~heap_string() { delete[] data_; }
+
+	[[nodiscard]] std::size_t size() const noexcept { return size_; }
+};
+
+/// @brief heap_string without the opt in, so growth takes the move and destroy path.
+class heap_string_unmarked : public heap_string {
+public:
+	using heap_string::heap_string;
+};
+
+} // end namespace
+
+namespace genesis {
+
+template <>
+struct is_trivially_relocatable<heap_string> : std::true_type {};
+
+} // end namespace genesis
+
+namespace {
+
+/// @brief The growth path of a vector, doubling raw storage and relocating the elements into it on every push that
+/// runs out of room. Only the relocations are timed, constructing the elements would drown them out.
+/// @return double millions of elements relocated per second.
+template <typename T, typename Relocate>
+double grow(std::size_t count, Relocate relocate, T (*make)(std::size_t)) {
+	std::chrono::duration<double> elapsed{0};
+	std::size_t relocated = 0;
+	for (std::size_t round = 0; round < total_elements / count; ++round) {
+		std::size_t capacity = 4;
+		std::size_t size = 0;
+		auto* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+		for (std::size_t i = 0; i < count; ++i) {
+			if (size == capacity) {
+				auto* grown = static_cast<T*>(::operator new(capacity * 2 * sizeof(T)));
+				auto start = std::chrono::steady_clock::now();
+				relocate(data, size, grown);
+				elapsed += std::chrono::steady_clock::now() - start;
+				relocated += size;
+				::operator delete(data);
+				data = grown;
+				capacity *= 2;
+			}
+			::new(static_cast<void*>(data + size)) T(make(i));
+			++size;
+		}
+		std::destroy_n(data, size);
+		::operator delete(data);
+	}
+	return static_cast<double>(relocated) / elapsed.count() / 1e6;
+}
+
+template <typename T>
+void move_and_destroy(T* data, std::size_t size, T* grown) {
+	std::uninitialized_move_n(data, size, grown);
+	std::destroy_n(data, size);
+}
+
+template <typename T>
+void relocate(T* data, std::size_t size, T* grown) {
+	genesis::uninitialized_relocate_n(data, size, grown);
+}
+
+template <typename Fast, typename Slow>
+void bench_growth(const char* name, Fast (*make_fast)(std::size_t), Slow (*make_slow)(std::size_t)) {
+	std::printf("growing a vector of %s by doubling, elements relocated per second (M/s)\n", name);
+	std::printf("%10s %18s %22s\n", "elements", "move and destroy", "uninitialized_relocate");
+	for (auto count : element_counts) {
+		auto slow = grow<Slow>(count, move_and_destroy<Slow>, make_slow);
+		auto fast = grow<Fast>(count, relocate<Fast>, make_fast);
+		std::printf("%10zu %18.2f %22.2f\n", count, slow, fast);
+	}
+}
+
+std::shared_ptr<int> make_shared_int(std::size_t i) { return std::make_shared<int>(static_cast<int>(i)); }
+
+heap_string make_heap_string(std::size_t) { return heap_string{"relocatable"}; }
+
+heap_string_unmarked make_heap_string_unmarked(std::size_t) { return heap_string_unmarked{"relocatable"}; }
+
+/// @brief std::shared_ptr is trivially relocatable either way, so the slow column forces the element by element path.
+struct shared_int {
+	std::shared_ptr<int> ptr;
+
+	shared_int(std::shared_ptr<int> init) noexcept : ptr{std::move(init)} { }
+
+	shared_int(shared_int&&) noexcept = default;
+};
+
+shared_int make_shared_int_unmarked(std::size_t i) { return shared_int{make_shared_int(i)}; }
+
+/// @brief Times initializing the same raw buffer over and over.
+/// @return double gigabytes initialized per second.
+template <typename T, typename Init>
+double initialize(Init init) {
+	auto* data = static_cast<T*>(::operator new(bulk_elements * sizeof(T)));
+	init(data);
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t round = 0; round < bulk_rounds; ++round) {
+		init(data);
+		// Keep the stores from being dropped as dead.
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	::operator delete(data);
+	return static_cast<double>(bulk_rounds * bulk_elements * sizeof(T)) / elapsed.count() / 1e9;
+}
+
+void bench_bulk() {
+	std::printf("initializing %zu elements of raw storage (GB/s)\n", bulk_elements);
+	std::printf("%34s %16s %16s\n", "", "construct_at", "bulk algorithm");
+	auto links_loop = initialize<std::atomic<uint32_t>>([](std::atomic<uint32_t>* data) {
+		for (std::size_t i = 0; i < bulk_elements; ++i) { genesis::construct_at(data + i, UINT32_MAX); }
+	});
+	auto links_bulk = initialize<std::atomic<uint32_t>>([](std::atomic<uint32_t>* data) {
+		genesis::uninitialized_fill_n(data, bulk_elements, UINT32_MAX);
+	});
+	std::printf("%34s %16.2f %16.2f\n", "fill atomic<uint32_t> (link table)", links_loop, links_bulk);
+	auto doubles_loop = initialize<double>([](double* data) {
+		for (std::size_t i = 0; i < bulk_elements; ++i) { genesis::construct_at(data + i); }
+	});
+	auto doubles_bulk = initialize<double>([](double* data) {
+		genesis::uninitialized_value_construct_n(data, bulk_elements);
+	});
+	std::printf("%34s %16.2f %16.2f\n", "value construct double", doubles_loop, doubles_bulk);
+	struct message { uint64_t id; uint32_t flags; uint32_t length; };
+	auto messages_loop = initialize<message>([](message* data) {
+		for (std::size_t i = 0; i < bulk_elements; ++i) { genesis::construct_at(data + i, message{0, 0xffffffffu, 64}); }
+	});
+	auto messages_bulk = initialize<message>([](message* data) {
+		genesis::uninitialized_fill_n(data, bulk_elements, message{0, 0xffffffffu, 64});
+	});
+	std::printf("%34s %16.2f %16.2f\n", "fill 16 byte struct", messages_loop, messages_bulk);
+}
+
+} // end namespace
+
+int main() {
+	bench_growth("std::shared_ptr<int>", make_shared_int, make_shared_int_unmarked);
+	bench_growth("heap_string", make_heap_string, make_heap_string_unmarked);
+	bench_bulk();
+	return 0;
+}
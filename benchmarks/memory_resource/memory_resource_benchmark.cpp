@@ -0,0 +1,149 @@
+#include "genesis/thread_caching_resource.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t thread_counts[] = {1, 4, 16};
+constexpr std::size_t iterations = 200'000;
+constexpr std::size_t live_blocks = 32;
+
+/// @brief Runs work on the given number of threads and returns the throughput in millions of operations per second.
+template <typename Work>
+double run_threads(std::size_t threads, std::size_t ops_per_thread, Work work) {
+	std::atomic<bool> go{false};
+	std::vector<std::thread> workers{};
+	workers.reserve(threads);
+	for (std::size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&go, &work] {
+			while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+			work();
+		});
+	}
+	auto start = std::chrono::steady_clock::now();
+	go.store(true, std::memory_order_release);
+	for (auto& w : workers) { w.join(); }
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(threads * ops_per_thread) / elapsed.count() / 1e6;
+}
+
+/// @brief Each thread keeps a ring of live blocks of mixed small sizes, freeing the oldest for every new one.
+/// Alloc and free are given the size so the same loop drives malloc and any memory resource.
+template <typename Alloc, typename Free>
+double churn(std::size_t threads, Alloc alloc, Free free) {
+	return run_threads(threads, iterations, [&alloc, &free] {
+		void* live[live_blocks] = {};
+		std::size_t sizes[live_blocks] = {};
+		std::uint32_t rng = 2463534242u;
+		for (std::size_t i = 0; i < iterations; ++i) {
+			auto slot = i % live_blocks;
+			if (live[slot] != nullptr) { free(live[slot], sizes[slot]); }
+			rng ^= rng << 13;
+			rng ^= rng >> 17;
+			rng ^= rng << 5;
+			sizes[slot] = std::size_t{16} << (rng % 6);
+			live[slot] = alloc(sizes[slot]);
+			*static_cast<std::byte*>(live[slot]) = std::byte{1};
+		}
+		for (std::size_t slot = 0; slot < live_blocks; ++slot) {
+			if (live[slot] != nullptr) { free(live[slot], sizes[slot]); }
+		}
+	});
+}
+
+double churn(std::size_t threads, std::pmr::memory_resource& resource) {
+	return churn(
+		threads,
+		[&resource](std::size_t size) { return resource.allocate(size, alignof(std::max_align_t)); },
+		[&resource](void* p, std::size_t size) { resource.deallocate(p, size, alignof(std::max_align_t)); }
+	);
+}
+
+void bench_churn() {
+	std::printf("small allocation churn, 16 to 512 bytes with %zu live blocks per thread (Mops/s)\n", live_blocks);
+	std::printf("%8s %12s %12s %14s %14s %16s\n", "threads", "malloc", "new_delete", "unsync_pool", "sync_pool", "thread_caching");
+	for (auto threads : thread_counts) {
+		auto malloc_rate = churn(
+			threads,
+			[](std::size_t size) { return std::malloc(size); },
+			[](void* p, std::size_t) { std::free(p); }
+		);
+		auto new_delete = churn(threads, *std::pmr::new_delete_resource());
+		// Not thread safe, so only measured single threaded.
+		double unsync = 0.0;
+		if (threads == 1) {
+			std::pmr::unsynchronized_pool_resource resource{};
+			unsync = churn(threads, resource);
+		}
+		std::pmr::synchronized_pool_resource sync{};
+		auto sync_rate = churn(threads, sync);
+		genesis::thread_caching_resource caching{};
+		auto caching_rate = churn(threads, caching);
+		if (threads == 1) {
+			std::printf("%8zu %12.2f %12.2f %14.2f %14.2f %16.2f\n", threads, malloc_rate, new_delete, unsync, sync_rate, caching_rate);
+		} else {
+			std::printf("%8zu %12.2f %12.2f %14s %14.2f %16.2f\n", threads, malloc_rate, new_delete, "-", sync_rate, caching_rate);
+		}
+	}
+}
+
+/// @brief One thread allocates and another frees, every block crosses threads.
+template <typename Alloc, typename Free>
+double handoff(Alloc alloc, Free free) {
+	constexpr std::size_t count = 1'000'000;
+	constexpr std::size_t ring_size = 1024;
+	std::vector<std::atomic<void*>> ring(ring_size);
+	auto start = std::chrono::steady_clock::now();
+	std::thread consumer{[&] {
+		for (std::size_t i = 0; i < count; ++i) {
+			auto& slot = ring[i % ring_size];
+			void* p = nullptr;
+			while ((p = slot.exchange(nullptr, std::memory_order_acquire)) == nullptr) { std::this_thread::yield(); }
+			free(p, 64);
+		}
+	}};
+	for (std::size_t i = 0; i < count; ++i) {
+		auto* p = alloc(64);
+		auto& slot = ring[i % ring_size];
+		while (slot.load(std::memory_order_relaxed) != nullptr) { std::this_thread::yield(); }
+		slot.store(p, std::memory_order_release);
+	}
+	consumer.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(count) / elapsed.count() / 1e6;
+}
+
+double handoff(std::pmr::memory_resource& resource) {
+	return handoff(
+		[&resource](std::size_t size) { return resource.allocate(size, alignof(std::max_align_t)); },
+		[&resource](void* p, std::size_t size) { resource.deallocate(p, size, alignof(std::max_align_t)); }
+	);
+}
+
+void bench_handoff() {
+	std::printf("producer allocates, consumer frees, 64 byte blocks (Mops/s)\n");
+	std::printf("%12s %12s %14s %16s\n", "malloc", "new_delete", "sync_pool", "thread_caching");
+	auto malloc_rate = handoff([](std::size_t size) { return std::malloc(size); }, [](void* p, std::size_t) { std::free(p); });
+	auto new_delete = handoff(*std::pmr::new_delete_resource());
+	std::pmr::synchronized_pool_resource sync{};
+	auto sync_rate = handoff(sync);
+	genesis::thread_caching_resource caching{};
+	auto caching_rate = handoff(caching);
+	std::printf("%12.2f %12.2f %14.2f %16.2f\n", malloc_rate, new_delete, sync_rate, caching_rate);
+}
+
+} // end namespace
+
+int main() {
+	bench_churn();
+	bench_handoff();
+	return 0;
+}
@@ -0,0 +1,312 @@
+#include "genesis/object_pool.hpp"
+#include "genesis/sharded_object_pool.hpp"
+#include "genesis/utility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t thread_counts[] = {1, 4, 16, 64};
+constexpr std::size_t iterations = 100'000;
+constexpr std::size_t working_set = 4;
+
+struct message {
+	uint64_t id;
+	uint64_t payload[7];
+};
+
+/// @brief Forwards to the default resource and counts the allocations the pool makes through it.
+class allocation_counter : public std::pmr::memory_resource {
+public:
+	std::atomic<std::size_t> allocations{0};
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		return std::pmr::get_default_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+		std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+/// @brief The same message in a pool whose head, waiter count and counters share lines with its other fields.
+struct packed_message : message {};
+
+} // end namespace
+
+namespace genesis {
+
+template <>
+struct object_pool_padding<packed_message> : std::false_type {};
+
+} // end namespace genesis
+
+namespace {
+
+/// @brief Runs work on the given number of threads and returns the throughput in millions of operations per second.
+template <typename Work>
+double run_threads(std::size_t threads, std::size_t ops_per_thread, Work work) {
+	std::atomic<bool> go{false};
+	std::vector<std::thread> workers{};
+	workers.reserve(threads);
+	for (std::size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&go, &work] {
+			while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+			work();
+		});
+	}
+	auto start = std::chrono::steady_clock::now();
+	go.store(true, std::memory_order_release);
+	for (auto& w : workers) { w.join(); }
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(threads * ops_per_thread) / elapsed.count() / 1e6;
+}
+
+/// @brief Each thread repeatedly borrows a small working set and returns it.
+double churn(std::size_t threads, const genesis::object_pool_options& opts) {
+	genesis::object_pool<message> pool{opts};
+	return run_threads(threads, iterations * working_set, [&pool] {
+		std::shared_ptr<message> held[working_set];
+		for (std::size_t i = 0; i < iterations; ++i) {
+			for (auto& h : held) {
+				if (auto o = pool.allocate(); o) { h = std::move(*o); }
+			}
+			for (auto& h : held) { h.reset(); }
+		}
+	});
+}
+
+/// @brief Treiber stack with a plain pointer head, the freelist object_pool had before the generation tag.
+/// The ABA race it is open to can only lose or share dummy nodes here, which the benchmark tolerates.
+struct pointer_head_stack {
+	struct node {
+		node* next;
+		message value;
+	};
+
+	std::vector<node> nodes;
+	std::atomic<node*> head{nullptr};
+
+	explicit pointer_head_stack(std::size_t count) :
+		nodes(count)
+	{
+		for (auto& n : nodes) { push(&n); }
+	}
+
+	node* pop() noexcept {
+		auto* old_head = head.load(std::memory_order_acquire);
+		while (old_head != nullptr && !head.compare_exchange_weak(old_head, old_head->next, std::memory_order_acquire, std::memory_order_acquire)) { }
+		return old_head;
+	}
+
+	void push(node* n) noexcept {
+		auto* old_head = head.load(std::memory_order_relaxed);
+		do {
+			n->next = old_head;
+		} while (!head.compare_exchange_weak(old_head, n, std::memory_order_release, std::memory_order_relaxed));
+	}
+};
+
+void bench_freelist() {
+	std::printf("freelist head, one borrow/return pair per iteration (Mops/s)\n");
+	std::printf("%8s %16s %16s\n", "threads", "pointer head", "tagged index");
+	for (auto threads : thread_counts) {
+		pointer_head_stack stack{threads * 2};
+		auto pointer = run_threads(threads, iterations, [&stack] {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				if (auto* n = stack.pop(); n != nullptr) {
+					n->value.id = i;
+					stack.push(n);
+				}
+			}
+		});
+		genesis::object_pool<message> pool{threads * 2};
+		auto tagged = run_threads(threads, iterations, [&pool] {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				if (auto o = pool.try_allocate(); o) { o->id = i; }
+			}
+		});
+		std::printf("%8zu %16.2f %16.2f\n", threads, pointer, tagged);
+	}
+}
+
+/// @brief Single threaded borrow/return through the given borrow function, reports Mops/s and the allocations per
+/// borrow the pool makes through its memory resource.
+template <typename Borrow>
+void borrow_path(const char* name, const allocation_counter& counter, Borrow borrow) {
+	constexpr std::size_t borrows = 1'000'000;
+	auto allocations = counter.allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < borrows; ++i) {
+		auto o = borrow();
+		o->id = i;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	auto per_borrow = static_cast<double>(counter.allocations.load() - allocations) / borrows;
+	std::printf("%16s %16.2f %16.2f\n", name, borrows / elapsed.count() / 1e6, per_borrow);
+}
+
+void bench_handles() {
+	allocation_counter counter{};
+	genesis::object_pool<message> pool{16, &counter};
+	std::printf("object_pool borrow handles, single thread\n");
+	std::printf("%16s %16s %16s\n", "handle", "Mops/s", "allocs/borrow");
+	borrow_path("std::shared_ptr", counter, [&pool] { return *pool.allocate(); });
+	borrow_path("pool_ptr", counter, [&pool] { return pool.try_allocate(); });
+}
+
+void bench_magazines() {
+	constexpr std::size_t magazine_size = 32;
+	std::printf("object_pool borrow/return throughput (Mops/s)\n");
+	std::printf("%8s %16s %16s\n", "threads", "global freelist", "magazines");
+	for (auto threads : thread_counts) {
+		// Leave room for every thread to fill its magazine so neither run hits exhaustion.
+		auto capacity = threads * (working_set + magazine_size) * 2;
+		auto global = churn(threads, genesis::object_pool_options{capacity, 0});
+		auto cached = churn(threads, genesis::object_pool_options{capacity, magazine_size});
+		std::printf("%8zu %16.2f %16.2f\n", threads, global, cached);
+	}
+}
+
+/// @brief Each thread borrows a batch of objects and returns it, either one object at a time or in bulk.
+void bench_bulk() {
+	constexpr std::size_t batches = 10'000;
+	std::printf("object_pool batch borrow/return throughput (Mobjects/s)\n");
+	std::printf("%8s %8s %16s %16s\n", "threads", "batch", "per-object", "bulk");
+	for (auto batch : {std::size_t{64}, std::size_t{256}}) {
+		for (auto threads : thread_counts) {
+			genesis::object_pool<message> single_pool{threads * batch};
+			auto single = run_threads(threads, batches * batch, [&single_pool, batch] {
+				std::vector<genesis::pool_ptr<message>> held{};
+				held.reserve(batch);
+				for (std::size_t i = 0; i < batches; ++i) {
+					for (std::size_t j = 0; j < batch; ++j) { held.push_back(single_pool.try_allocate()); }
+					held.clear();
+				}
+			});
+			genesis::object_pool<message> bulk_pool{threads * batch};
+			auto bulk = run_threads(threads, batches * batch, [&bulk_pool, batch] {
+				std::vector<genesis::pool_ptr<message>> held{};
+				held.reserve(batch);
+				for (std::size_t i = 0; i < batches; ++i) {
+					bulk_pool.allocate_n(batch, std::back_inserter(held));
+					bulk_pool.deallocate_n(held);
+					held.clear();
+				}
+			});
+			std::printf("%8zu %8zu %16.2f %16.2f\n", threads, batch, single, bulk);
+		}
+	}
+}
+
+/// @brief Each thread repeatedly borrows a small working set and returns it, through pool_ptr handles.
+template <typename Pool>
+double churn_unique(std::size_t threads, Pool& pool) {
+	return run_threads(threads, iterations * working_set, [&pool] {
+		genesis::pool_ptr<message> held[working_set];
+		for (std::size_t i = 0; i < iterations; ++i) {
+			for (auto& h : held) { h = pool.try_allocate(); }
+			for (auto& h : held) { h.reset(); }
+		}
+	});
+}
+
+void bench_sharded() {
+	auto shards = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	std::printf("object_pool vs sharded_object_pool with %zu shards, borrow/return throughput (Mops/s)\n", shards);
+	std::printf("%8s %16s %16s\n", "threads", "object_pool", "sharded");
+	for (auto threads : thread_counts) {
+		auto capacity = threads * working_set * 2;
+		genesis::object_pool<message> single{capacity};
+		auto global = churn_unique(threads, single);
+		genesis::sharded_object_pool<message> sharded{genesis::object_pool_options{std::max(capacity, shards * working_set * 2)}, shards};
+		auto per_cpu = churn_unique(threads, sharded);
+		std::printf("%8zu %16.2f %16.2f\n", threads, global, per_cpu);
+	}
+}
+
+/// @brief Single threaded borrow/return through pool_ptr handles with each concurrency policy.
+template <typename Concurrency>
+double policy_churn() {
+	genesis::object_pool<message, Concurrency> pool{working_set};
+	return run_threads(1, iterations * working_set, [&pool] {
+		genesis::pool_ptr<message, Concurrency> held[working_set];
+		for (std::size_t i = 0; i < iterations; ++i) {
+			for (auto& h : held) { h = pool.try_allocate(); }
+			for (auto& h : held) { h.reset(); }
+		}
+	});
+}
+
+void bench_policies() {
+	std::printf("object_pool concurrency policies, single thread borrow/return throughput (Mops/s)\n");
+	std::printf("%16s %16s %16s\n", "mpmc", "spsc", "single_thread");
+	auto mpmc = policy_churn<genesis::pool_mpmc>();
+	auto spsc = policy_churn<genesis::pool_spsc>();
+	auto single = policy_churn<genesis::pool_single_thread>();
+	std::printf("%16.2f %16.2f %16.2f\n", mpmc, spsc, single);
+}
+
+/// @brief Half the threads borrow and return while the other half poll capacity() and waiters(), the way a
+/// monitoring thread would. Reports the borrow/return throughput in Mops/s.
+template <typename Message>
+double false_sharing(std::size_t threads) {
+	genesis::object_pool<Message> pool{threads * 2};
+	std::atomic<std::size_t> next_thread{0};
+	std::atomic<bool> done{false};
+	std::atomic<std::size_t> polls{0};
+	auto borrowers = (threads + 1) / 2;
+	auto start = std::chrono::steady_clock::now();
+	run_threads(threads, iterations, [&] {
+		if (next_thread.fetch_add(1) < borrowers) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				if (auto o = pool.try_allocate(); o) { o->id = i; }
+			}
+			done.store(true, std::memory_order_relaxed);
+		} else {
+			std::size_t seen = 0;
+			while (!done.load(std::memory_order_relaxed)) { seen += pool.capacity() + pool.waiters(); }
+			polls.fetch_add(seen != 0 ? 1 : 0);
+		}
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(borrowers * iterations) / elapsed.count() / 1e6;
+}
+
+void bench_false_sharing() {
+	std::printf("object_pool hot fields packed vs cache_padded, borrow/return throughput next to pollers (Mops/s)\n");
+	if (GENESIS_OBJECT_POOL_STATS == 0) { std::printf("(build with GENESIS_OBJECT_POOL_STATS=1 to include the counters)\n"); }
+	std::printf("%8s %16s %16s\n", "threads", "packed", "cache_padded");
+	for (auto threads : {std::size_t{2}, std::size_t{4}, std::size_t{16}}) {
+		auto packed = false_sharing<packed_message>(threads);
+		auto padded = false_sharing<message>(threads);
+		std::printf("%8zu %16.2f %16.2f\n", threads, packed, padded);
+	}
+}
+
+} // end namespace
+
+int main() {
+	bench_handles();
+	bench_freelist();
+	bench_magazines();
+	bench_bulk();
+	bench_sharded();
+	bench_policies();
+	bench_false_sharing();
+	return 0;
+}
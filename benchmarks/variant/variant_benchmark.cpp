@@ -0,0 +1,129 @@
+#include "genesis/variant.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <variant>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t message_count = 1 << 20;
+constexpr std::size_t rounds = 100;
+
+struct heartbeat { uint32_t sequence; };
+struct add_order { uint64_t id; uint32_t price; uint32_t quantity; };
+struct cancel_order { uint64_t id; };
+struct modify_order { uint64_t id; uint32_t quantity; };
+struct trade { uint64_t id; uint64_t match; uint32_t price; uint32_t quantity; };
+struct snapshot_begin { uint32_t symbol; };
+struct snapshot_end { uint32_t symbol; uint32_t count; };
+struct status { uint8_t state; };
+
+/// @brief One overload per message type, each cheap enough that the dispatch itself dominates.
+struct handler {
+	uint64_t operator()(const heartbeat& m) const noexcept { return m.sequence; }
+	uint64_t operator()(const add_order& m) const noexcept { return m.id + m.price * m.quantity; }
+	uint64_t operator()(const cancel_order& m) const noexcept { return m.id ^ 0x5555u; }
+	uint64_t operator()(const modify_order& m) const noexcept { return m.id - m.quantity; }
+	uint64_t operator()(const trade& m) const noexcept { return m.match + m.price; }
+	uint64_t operator()(const snapshot_begin& m) const noexcept { return m.symbol << 1; }
+	uint64_t operator()(const snapshot_end& m) const noexcept { return m.symbol + m.count; }
+	uint64_t operator()(const status& m) const noexcept { return m.state; }
+};
+
+using genesis_message = genesis::variant<
+	heartbeat, add_order, cancel_order, modify_order, trade, snapshot_begin, snapshot_end, status
+>;
+
+using std_message = std::variant<
+	heartbeat, add_order, cancel_order, modify_order, trade, snapshot_begin, snapshot_end, status
+>;
+
+/// @brief The dispatch loops are kept out of line so their code can be compared with objdump -d --no-show-raw-insn
+/// on the benchmark binary.
+[[gnu::noinline]] uint64_t dispatch_genesis(const std::vector<genesis_message>& messages) {
+	uint64_t sum = 0;
+	for (const auto& m : messages) { sum += genesis::visit(handler{}, m); }
+	return sum;
+}
+
+[[gnu::noinline]] uint64_t dispatch_std(const std::vector<std_message>& messages) {
+	uint64_t sum = 0;
+	for (const auto& m : messages) { sum += std::visit(handler{}, m); }
+	return sum;
+}
+
+/// @brief A stream of messages of random type, the same sequence for both variants.
+template <typename Message>
+std::vector<Message> make_messages() {
+	std::mt19937 rng{42};
+	std::uniform_int_distribution<uint32_t> pick{0, 7};
+	std::vector<Message> messages{};
+	messages.reserve(message_count);
+	for (std::size_t i = 0; i < message_count; ++i) {
+		auto n = static_cast<uint32_t>(i);
+		switch (pick(rng)) {
+			case 0: messages.emplace_back(heartbeat{n}); break;
+			case 1: messages.emplace_back(add_order{i, n, 10}); break;
+			case 2: messages.emplace_back(cancel_order{i}); break;
+			case 3: messages.emplace_back(modify_order{i, 5}); break;
+			case 4: messages.emplace_back(trade{i, i + 1, n, 3}); break;
+			case 5: messages.emplace_back(snapshot_begin{n}); break;
+			case 6: messages.emplace_back(snapshot_end{n, 2}); break;
+			default: messages.emplace_back(status{1}); break;
+		}
+	}
+	return messages;
+}
+
+/// @return double millions of messages dispatched per second.
+template <typename Message, typename Dispatch>
+double bench_dispatch(Dispatch dispatch, uint64_t& checksum) {
+	auto messages = make_messages<Message>();
+	checksum = dispatch(messages);
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t round = 0; round < rounds; ++round) {
+		checksum += dispatch(messages);
+		// The dispatch loops only read memory, keep the repeated calls from being folded into one.
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(rounds * message_count) / elapsed.count() / 1e6;
+}
+
+/// @return double millions of messages copied per second.
+template <typename Message>
+double bench_copy() {
+	auto messages = make_messages<Message>();
+	std::vector<Message> copy(messages.size());
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t round = 0; round < rounds; ++round) {
+		copy = messages;
+		messages.swap(copy);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(rounds * message_count) / elapsed.count() / 1e6;
+}
+
+} // end namespace
+
+int main() {
+	std::printf("%zu messages of 8 types in random order\n", message_count);
+	std::printf("%22s %16s %16s\n", "", "std::variant", "genesis::variant");
+	std::printf("%22s %16zu %16zu\n", "sizeof (bytes)", sizeof(std_message), sizeof(genesis_message));
+	uint64_t std_sum = 0;
+	uint64_t genesis_sum = 0;
+	auto std_rate = bench_dispatch<std_message>(dispatch_std, std_sum);
+	auto genesis_rate = bench_dispatch<genesis_message>(dispatch_genesis, genesis_sum);
+	std::printf("%22s %16.2f %16.2f\n", "visit (M msgs/s)", std_rate, genesis_rate);
+	std::printf("%22s %16.2f %16.2f\n", "vector copy (M msgs/s)", bench_copy<std_message>(), bench_copy<genesis_message>());
+	if (std_sum != genesis_sum) {
+		std::printf("checksum mismatch %llu != %llu\n", static_cast<unsigned long long>(std_sum), static_cast<unsigned long long>(genesis_sum));
+		return 1;
+	}
+	return 0;
+}
@@ -55,6 +55,10 @@ if (NOT DEFINED BUILD_EXAMPLES)
 	set(BUILD_EXAMPLES ON)
 endif()
 
+if (NOT DEFINED BUILD_BENCHMARKS)
+	set(BUILD_BENCHMARKS OFF)
+endif()
+
 if(NOT DEFINED CMAKE_INSTALL_PREFIX)
 	set(CMAKE_INSTALL_PREFIX ${CMAKE_CURRENT_SOURCE_DIR}/installed_artifacts)
 endif()
@@ -0,0 +1,204 @@
+#if !defined GENESIS_ARENA_RESOURCE_HEADER_INCLUDED
+#define GENESIS_ARENA_RESOURCE_HEADER_INCLUDED
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+namespace genesis {
+
+namespace details {
+
+/// @brief Header at the start of every overflow block an arena_resource takes from its upstream resource.
+struct alignas(std::max_align_t) arena_block {
+	arena_block* next_;
+	std::size_t size_;  // Total size of the block, header included
+
+	[[nodiscard]] std::byte* begin() noexcept { return reinterpret_cast<std::byte*>(this) + sizeof(arena_block); }
+
+	[[nodiscard]] std::byte* end() noexcept { return reinterpret_cast<std::byte*>(this) + size_; }
+};
+
+} // end namespace details
+
+/// @brief A checkpoint of an arena_resource, see arena_resource::mark.
+class arena_mark {
+private:
+	details::arena_block* block_;
+	std::byte* cursor_;
+
+	arena_mark(details::arena_block* init_block, std::byte* init_cursor) noexcept :
+		block_{init_block},
+		cursor_{init_cursor}
+	{ }
+
+	friend class arena_resource;
+};
+
+/// @brief The arena_resource class is a monotonic std::pmr::memory_resource for scratch memory. It bumps a
+/// pointer through an initial buffer, then through overflow blocks from the upstream resource, and never frees
+/// individual allocations. mark() and rewind() free everything allocated since a checkpoint in O(1).
+/// Overflow blocks are kept after a rewind and reused, so a request loop that rewinds every iteration stops
+/// calling the upstream resource once its largest request has been seen. Not thread safe.
+class arena_resource : public std::pmr::memory_resource {
+private:
+	std::byte* initial_;
+	std::size_t initial_size_;
+	std::pmr::memory_resource* upstream_;
+	// Overflow blocks in the order they are used. The current block and those before it are in use,
+	// the ones after it are spare.
+	details::arena_block* blocks_;
+	details::arena_block* current_;  // nullptr while bumping through the initial buffer
+	std::byte* cursor_;
+	std::byte* end_;
+	std::size_t next_block_size_;
+
+	// Smallest overflow block, header included.
+	static constexpr std::size_t min_block_size = 4096;
+
+public:
+	/// @brief Construct a new arena_resource object that starts in the given buffer.
+	/// @param buffer Storage to allocate from first, it must outlive the arena. May be nullptr if size is 0.
+	/// @param size The size of the buffer in bytes.
+	/// @param upstream The resource overflow blocks are taken from.
+	arena_resource(void* buffer, std::size_t size, std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept :
+		initial_{static_cast<std::byte*>(buffer)},
+		initial_size_{size},
+		upstream_{upstream},
+		blocks_{nullptr},
+		current_{nullptr},
+		cursor_{initial_},
+		end_{initial_ + size},
+		next_block_size_{std::max(min_block_size, size)}
+	{ }
+
+	/// @brief Construct a new arena_resource object without an initial buffer.
+	/// @param upstream The resource overflow blocks are taken from.
+	explicit arena_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept :
+		arena_resource{nullptr, 0, upstream}
+	{ }
+
+	arena_resource(const arena_resource&) = delete;
+
+	arena_resource& operator=(const arena_resource&) = delete;
+
+	~arena_resource() override { release(); }
+
+	/// @brief Upstream observor for arena_resource.
+	/// @return std::pmr::memory_resource* the resource overflow blocks come from.
+	[[nodiscard]] std::pmr::memory_resource* upstream_resource() const noexcept { return upstream_; }
+
+	/// @brief The number of overflow blocks held, in use or spare.
+	/// @return std::size_t
+	[[nodiscard]] std::size_t block_count() const noexcept {
+		std::size_t count = 0;
+		for (auto* b = blocks_; b != nullptr; b = b->next_) { ++count; }
+		return count;
+	}
+
+	/// @brief Takes a checkpoint of the arena to rewind to later.
+	/// @return arena_mark
+	[[nodiscard]] arena_mark mark() const noexcept { return arena_mark{current_, cursor_}; }
+
+	/// @brief Frees everything allocated since the mark was taken, keeping the overflow blocks for reuse.
+	/// Marks taken after this one are invalidated.
+	/// @param m A mark of this arena.
+	void rewind(const arena_mark& m) noexcept {
+		current_ = m.block_;
+		cursor_ = m.cursor_;
+		end_ = current_ != nullptr ? current_->end() : initial_ + initial_size_;
+	}
+
+	/// @brief Frees everything, keeping the overflow blocks for reuse.
+	void reset() noexcept { rewind(arena_mark{nullptr, initial_}); }
+
+	/// @brief Frees everything and hands every overflow block back to the upstream resource.
+	void release() noexcept {
+		while (blocks_ != nullptr) {
+			auto* b = blocks_;
+			blocks_ = b->next_;
+			upstream_->deallocate(b, b->size_, alignof(details::arena_block));
+		}
+		next_block_size_ = std::max(min_block_size, initial_size_);
+		reset();
+	}
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		if (auto* p = bump(bytes, alignment); p != nullptr) { return p; }
+		next_block(bytes, alignment);
+		return bump(bytes, alignment);
+	}
+
+	void do_deallocate(void*, std::size_t, std::size_t) override { }
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	[[nodiscard]] void* bump(std::size_t bytes, std::size_t alignment) noexcept {
+		auto address = reinterpret_cast<std::uintptr_t>(cursor_);
+		auto padding = (alignment - address % alignment) % alignment;
+		if (cursor_ == nullptr || static_cast<std::size_t>(end_ - cursor_) < padding || static_cast<std::size_t>(end_ - cursor_) - padding < bytes) {
+			return nullptr;
+		}
+		auto* p = cursor_ + padding;
+		cursor_ = p + bytes;
+		return p;
+	}
+
+	/// @brief Moves on to the next spare block if it fits the request, otherwise inserts a new one in front of it.
+	void next_block(std::size_t bytes, std::size_t alignment) {
+		auto needed = sizeof(details::arena_block) + bytes + (alignment > alignof(details::arena_block) ? alignment : 0);
+		auto*& link = current_ != nullptr ? current_->next_ : blocks_;
+		auto* b = link;
+		if (b == nullptr || b->size_ < needed) {
+			auto size = std::max(next_block_size_, needed);
+			b = static_cast<details::arena_block*>(upstream_->allocate(size, alignof(details::arena_block)));
+			b->next_ = link;
+			b->size_ = size;
+			link = b;
+			next_block_size_ = size * 2;
+		}
+		current_ = b;
+		cursor_ = b->begin();
+		end_ = b->end();
+	}
+};
+
+namespace details {
+
+/// @brief Inline buffer of an inline_arena_resource. A base class of the arena so it exists before the
+/// arena_resource base that points into it.
+template <std::size_t N>
+struct inline_arena_storage {
+	alignas(std::max_align_t) std::byte buffer_[N];
+};
+
+} // end namespace details
+
+/// @brief An arena_resource that starts in an inline buffer of N bytes, so per-request scratch memory can live
+/// on the stack and only reaches the upstream resource once a request outgrows it.
+/// @tparam N The size of the inline buffer in bytes.
+template <std::size_t N>
+class inline_arena_resource : private details::inline_arena_storage<N>, public arena_resource {
+private:
+	using storage = details::inline_arena_storage<N>;
+
+public:
+	/// @brief Construct a new inline_arena_resource object.
+	/// @param upstream The resource overflow blocks are taken from.
+	explicit inline_arena_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept :
+		arena_resource{storage::buffer_, N, upstream}
+	{ }
+
+	inline_arena_resource(const inline_arena_resource&) = delete;
+
+	inline_arena_resource& operator=(const inline_arena_resource&) = delete;
+};
+
+} // end namespace genesis
+
+#endif
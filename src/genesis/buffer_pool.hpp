@@ -0,0 +1,291 @@
+#if !defined GENESIS_BUFFER_POOL_HEADER_INCLUDED
+#define GENESIS_BUFFER_POOL_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/object_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace genesis {
+
+namespace details {
+
+/// @brief The default options for the object_pool behind each size class of a buffer_pool.
+[[nodiscard]] inline object_pool_options default_buffer_class_options() noexcept {
+	object_pool_options opts{};
+	opts.capacity = 64;
+	opts.construction = pool_construction::lazy;
+	return opts;
+}
+
+} // end namespace details
+
+/// @brief Construction options for buffer_pool.
+struct buffer_pool_options {
+	/// @brief The smallest size class in bytes, rounded up to a power of two.
+	std::size_t min_size{512};
+	/// @brief The largest size class in bytes, rounded up to a power of two. Larger requests throw.
+	std::size_t max_size{std::size_t{1} << 20};
+	/// @brief Alignment of every buffer, a power of two. Classes smaller than this are aligned to their own size,
+	/// which is always enough for O_DIRECT on 512 byte sectors and for any SIMD load.
+	std::size_t alignment{4096};
+	/// @brief Options for the object_pool behind each size class. Lazy by default so a class only allocates the
+	/// buffers it actually hands out.
+	object_pool_options class_options{details::default_buffer_class_options()};
+};
+
+/// @brief Occupancy of one size class of a buffer_pool.
+struct buffer_class_stats {
+	/// @brief The capacity in bytes of every buffer in the class.
+	std::size_t size;
+	/// @brief The number of buffers the class holds, including the ones not allocated yet by a lazy class.
+	std::size_t capacity;
+	/// @brief The number of buffers currently borrowed.
+	std::size_t borrowed;
+};
+
+namespace details {
+
+struct buffer_class;
+
+/// @brief The pooled object of a size class, owns one aligned block of memory.
+struct buffer_block {
+	buffer_class* owner_;
+	std::byte* data_;
+
+	buffer_block(buffer_class* init_owner, std::byte* init_data) noexcept :
+		owner_{init_owner},
+		data_{init_data}
+	{ }
+
+	buffer_block(const buffer_block&) = delete;
+
+	buffer_block(buffer_block&& other) noexcept :
+		owner_{other.owner_},
+		data_{std::exchange(other.data_, nullptr)}
+	{ }
+
+	buffer_block& operator=(const buffer_block&) = delete;
+
+	buffer_block& operator=(buffer_block&&) = delete;
+
+	~buffer_block();
+};
+
+/// @brief One size class, an object_pool of equally sized blocks plus its occupancy.
+struct buffer_class {
+	std::pmr::memory_resource* resource_;
+	std::size_t size_;
+	std::size_t alignment_;
+	std::atomic<std::size_t> borrowed_;
+	// Declared last so the blocks are freed while the fields above are still alive.
+	object_pool<buffer_block> pool_;
+
+	buffer_class(std::size_t init_size, std::size_t init_alignment, const object_pool_options& opts, std::pmr::memory_resource* resource) :
+		resource_{resource},
+		size_{init_size},
+		alignment_{init_alignment},
+		borrowed_{0},
+		pool_{opts, [this] { return buffer_block{this, static_cast<std::byte*>(resource_->allocate(size_, alignment_))}; }, resource}
+	{ }
+};
+
+inline buffer_block::~buffer_block() {
+	if (data_ != nullptr) { owner_->resource_->deallocate(data_, owner_->size_, owner_->alignment_); }
+}
+
+} // end namespace details
+
+/// @brief Move only handle to a buffer borrowed from a buffer_pool, returning it to its size class on destruction.
+/// The buffer has a fixed capacity, the power of two of its class, and a size that the user may change up to it.
+class pool_buffer {
+private:
+	pool_ptr<details::buffer_block> block_;
+	std::size_t size_;
+
+	pool_buffer(pool_ptr<details::buffer_block> init_block, std::size_t init_size) noexcept :
+		block_{std::move(init_block)},
+		size_{init_size}
+	{ }
+
+	friend class buffer_pool;
+
+public:
+	pool_buffer() noexcept :
+		block_{},
+		size_{0}
+	{ }
+
+	pool_buffer(const pool_buffer&) = delete;
+
+	pool_buffer(pool_buffer&& other) noexcept :
+		block_{std::move(other.block_)},
+		size_{std::exchange(other.size_, 0)}
+	{ }
+
+	pool_buffer& operator=(const pool_buffer&) = delete;
+
+	pool_buffer& operator=(pool_buffer&& other) noexcept {
+		if (this != &other) {
+			reset();
+			block_ = std::move(other.block_);
+			size_ = std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+	~pool_buffer() { reset(); }
+
+	/// @brief Returns the buffer to its size class, leaving the handle empty.
+	void reset() noexcept {
+		if (block_) {
+			block_->owner_->borrowed_.fetch_sub(1, std::memory_order_relaxed);
+			block_.reset();
+		}
+		size_ = 0;
+	}
+
+	/// @brief Changes the number of bytes in use, the contents are left as they are.
+	/// @param new_size The new size, at most capacity().
+	void resize(std::size_t new_size) {
+		if (new_size > capacity()) {
+			throw std::length_error{"pool_buffer size exceeds its capacity"};
+		}
+		size_ = new_size;
+	}
+
+	[[nodiscard]] std::byte* data() const noexcept { return block_ ? block_->data_ : nullptr; }
+
+	[[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+	[[nodiscard]] std::size_t capacity() const noexcept { return block_ ? block_->owner_->size_ : 0; }
+
+	[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+	[[nodiscard]] std::byte* begin() const noexcept { return data(); }
+
+	[[nodiscard]] std::byte* end() const noexcept { return data() + size_; }
+
+	explicit operator bool() const noexcept { return static_cast<bool>(block_); }
+};
+
+/// @brief The buffer_pool class hands out byte buffers from power of two size classes, each backed by an
+/// object_pool of aligned blocks, so variable sized I/O buffers are reused rather than allocated per request.
+/// A request is served from the smallest class that fits it, never from a larger class.
+class buffer_pool {
+private:
+	std::vector<std::unique_ptr<details::buffer_class>> classes_;
+	std::size_t min_size_;
+	std::size_t max_size_;
+
+	// How long allocate waits for a buffer to be returned to an exhausted class, as object_pool::allocate does.
+	static constexpr std::chrono::milliseconds default_wait{50};
+
+public:
+	/// @brief Construct a new buffer_pool object.
+	/// @param opts The options for the buffer_pool, see buffer_pool_options.
+	/// @param mem_resource The memory resource for the buffers and the bookkeeping of every class.
+	explicit buffer_pool(const buffer_pool_options& opts = {}, std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()) :
+		classes_{},
+		min_size_{round_up(opts.min_size)},
+		max_size_{round_up(opts.max_size)}
+	{
+		if (opts.min_size == 0 || opts.max_size < opts.min_size || max_size_ == 0) {
+			throw std::invalid_argument{"buffer_pool size classes need 0 < min_size <= max_size"};
+		}
+		if (opts.alignment == 0 || (opts.alignment & (opts.alignment - 1)) != 0) {
+			throw std::invalid_argument{"buffer_pool alignment must be a power of two"};
+		}
+		for (auto size = min_size_; size <= max_size_ && size != 0; size <<= 1) {
+			auto alignment = std::min(opts.alignment, size);
+			classes_.push_back(std::make_unique<details::buffer_class>(size, alignment, opts.class_options, mem_resource));
+		}
+	}
+
+	buffer_pool(const buffer_pool&) = delete;
+
+	buffer_pool(buffer_pool&&) = delete;
+
+	buffer_pool& operator=(const buffer_pool&) = delete;
+
+	buffer_pool& operator=(buffer_pool&&) = delete;
+
+	/// @brief Class count observor for buffer_pool.
+	/// @return std::size_t the number of size classes.
+	[[nodiscard]] std::size_t class_count() const noexcept { return classes_.size(); }
+
+	/// @brief Largest size observor for buffer_pool.
+	/// @return std::size_t the largest buffer the pool hands out.
+	[[nodiscard]] std::size_t max_size() const noexcept { return max_size_; }
+
+	/// @brief Borrows a buffer of at least size bytes without waiting.
+	/// @param size The number of bytes wanted, the returned buffer has this size.
+	/// @return pool_buffer the borrowed buffer, empty if its size class is exhausted.
+	[[nodiscard]] pool_buffer try_allocate(std::size_t size) {
+		auto& cls = class_for(size);
+		return wrap(cls, cls.pool_.try_allocate(), size);
+	}
+
+	/// @brief Borrows a buffer of at least size bytes, waiting up to 50ms for one to be returned if its size
+	/// class is exhausted.
+	/// @param size The number of bytes wanted, the returned buffer has this size.
+	/// @return pool_buffer the borrowed buffer, empty if none became available.
+	[[nodiscard]] pool_buffer allocate(std::size_t size) { return allocate_for(size, default_wait); }
+
+	/// @brief Borrows a buffer of at least size bytes, waiting at most rel_time for one to be returned.
+	/// @param size The number of bytes wanted, the returned buffer has this size.
+	/// @param rel_time The longest time to wait for.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return pool_buffer the borrowed buffer, empty on timeout or stop.
+	template <typename Rep, typename Period>
+	[[nodiscard]] pool_buffer allocate_for(std::size_t size, const std::chrono::duration<Rep, Period>& rel_time, inplace_stop_token token = {}) {
+		auto& cls = class_for(size);
+		return wrap(cls, cls.pool_.allocate_unique_for(rel_time, token), size);
+	}
+
+	/// @brief Takes a snapshot of the occupancy of every size class, smallest class first.
+	/// @return std::vector<buffer_class_stats>
+	[[nodiscard]] std::vector<buffer_class_stats> stats() const {
+		std::vector<buffer_class_stats> snapshot{};
+		snapshot.reserve(classes_.size());
+		for (const auto& cls : classes_) {
+			snapshot.push_back({cls->size_, cls->pool_.capacity(), cls->borrowed_.load(std::memory_order_relaxed)});
+		}
+		return snapshot;
+	}
+
+private:
+	[[nodiscard]] static std::size_t round_up(std::size_t size) noexcept {
+		std::size_t rounded = 1;
+		while (rounded < size && rounded != 0) { rounded <<= 1; }
+		return rounded;
+	}
+
+	details::buffer_class& class_for(std::size_t size) {
+		if (size > max_size_) {
+			throw std::length_error{"buffer_pool request exceeds the largest size class"};
+		}
+		std::size_t k = 0;
+		for (auto class_size = min_size_; class_size < size; class_size <<= 1) { ++k; }
+		return *classes_[k];
+	}
+
+	[[nodiscard]] static pool_buffer wrap(details::buffer_class& cls, pool_ptr<details::buffer_block> block, std::size_t size) noexcept {
+		if (!block) { return pool_buffer{}; }
+		cls.borrowed_.fetch_add(1, std::memory_order_relaxed);
+		return pool_buffer{std::move(block), size};
+	}
+};
+
+} // end namespace genesis
+
+#endif
@@ -23,6 +23,9 @@
 //   GENESIS_ARCH_ARM
 // GENESIS_ARCH_VERSION is set appropriately
 
+// Cache line - the granularity at which cores contend for memory
+//   GENESIS_CACHELINE_SIZE, may be defined ahead of this header to override the per architecture default
+
 // GENESIS_POSIX is set if the platform natively supports POSIX calls
 // GENESIS_MICROSOFT is set if the platform natively supports Microsoft calls
 // Note - Microsoft does support some Posix calls
@@ -254,6 +257,18 @@
 // end of architecture section
 #endif
 
+#if !defined GENESIS_CACHELINE_SIZE
+
+// Apple's arm64 cores use 128 byte lines, the other supported architectures use 64 byte lines.
+#if GENESIS_ARCH_ARM && defined __APPLE__ && (defined __aarch64__ || defined __arm64__)
+#define GENESIS_CACHELINE_SIZE 128
+#else
+#define GENESIS_CACHELINE_SIZE 64
+#endif
+
+// end of cache line section
+#endif
+
 #if !defined CONSTEXPR11
 // if not defined by specific compiler
 
@@ -0,0 +1,96 @@
+#if !defined GENESIS_ATOMIC_WAIT_HEADER_INCLUDED
+#define GENESIS_ATOMIC_WAIT_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/config.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if GENESIS_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif GENESIS_MICROSOFT
+#include <windows.h>
+#if defined _MSC_VER
+#pragma comment(lib, "Synchronization.lib")
+#endif
+#endif
+
+namespace genesis {
+
+namespace details {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free);
+
+/// @brief Blocks the calling thread while word still holds expected, until woken or the deadline passes.
+/// Like a futex it may return spuriously, callers re-check their condition in a loop.
+/// @param deadline time_point::max() waits without a timeout.
+inline void atomic_wait_until(
+	std::atomic<uint32_t>& word,
+	uint32_t expected,
+	std::chrono::steady_clock::time_point deadline
+) noexcept {
+	using namespace std::chrono;
+	auto remaining = deadline == steady_clock::time_point::max()
+		? nanoseconds::max()
+		: duration_cast<nanoseconds>(deadline - steady_clock::now());
+	if (remaining <= nanoseconds::zero()) { return; }
+#if GENESIS_LINUX
+	timespec timeout{};
+	timespec* timeout_ptr = nullptr;
+	if (remaining != nanoseconds::max()) {
+		auto secs = duration_cast<seconds>(remaining);
+		timeout.tv_sec = static_cast<time_t>(secs.count());
+		timeout.tv_nsec = static_cast<long>((remaining - secs).count());
+		timeout_ptr = &timeout;
+	}
+	::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout_ptr, nullptr, 0);
+#elif GENESIS_MICROSOFT
+	DWORD timeout = INFINITE;
+	if (remaining != nanoseconds::max()) {
+		auto millis = duration_cast<milliseconds>(remaining + milliseconds{1} - nanoseconds{1}).count();
+		timeout = static_cast<DWORD>(std::min<long long>(millis, INFINITE - 1));
+	}
+	::WaitOnAddress(reinterpret_cast<volatile VOID*>(&word), &expected, sizeof(expected), timeout);
+#else
+	// No address based wait available, poll with short sleeps instead.
+	if (word.load(std::memory_order_acquire) == expected) {
+		std::this_thread::sleep_for(std::min<nanoseconds>(remaining, microseconds{100}));
+	}
+#endif
+}
+
+/// @brief Wakes up to count threads blocked in atomic_wait_until on word.
+inline void atomic_notify(std::atomic<uint32_t>& word, uint32_t count) noexcept {
+#if GENESIS_LINUX
+	auto n = static_cast<int>(std::min<uint32_t>(count, INT_MAX));
+	::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, n, nullptr, nullptr, 0);
+#elif GENESIS_MICROSOFT
+	if (count == 1) {
+		::WakeByAddressSingle(reinterpret_cast<PVOID>(&word));
+	} else {
+		::WakeByAddressAll(reinterpret_cast<PVOID>(&word));
+	}
+#else
+	(void) word;
+	(void) count;
+#endif
+}
+
+/// @brief Wakes every thread blocked in atomic_wait_until on word.
+inline void atomic_notify_all(std::atomic<uint32_t>& word) noexcept {
+	atomic_notify(word, UINT32_MAX);
+}
+
+} // end namespace details
+
+} // end namespace genesis
+
+#endif
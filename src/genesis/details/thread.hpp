@@ -4,16 +4,55 @@
 
 #include "genesis/config.hpp"
 
+#include <atomic>
+#include <cstddef>
 #include <thread>
 
+#if GENESIS_LINUX
+#include <sched.h>
+#elif GENESIS_MICROSOFT
+#include <windows.h>
+#endif
+
 #if __has_include(<xmmintrin.h>)
 #include <xmmintrin.h>
 inline void mm_pause() { _mm_pause(); }
 #elif defined(_MSC_VER)
 #include <intrin.h>
 inline void mm_pause() { _mm_pause(); }
+#elif GENESIS_ARCH_ARM
+inline void mm_pause() { __asm__ __volatile__("yield"); }
 #else
-inline void mm_pause() __asm__ __volatile__("pause")
+inline void mm_pause() { }
 #endif
 
-#endif
\ No newline at end of file
+namespace genesis {
+
+namespace details {
+
+/// @brief A small id handed out to every thread on first use, stands in for the CPU number where the
+/// platform can't report it.
+inline std::size_t thread_slot() noexcept {
+	static std::atomic<std::size_t> next_slot{0};
+	static thread_local std::size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+	return slot;
+}
+
+/// @brief The CPU the calling thread is currently running on. The answer may be stale by the time it is
+/// used, it is only meant to spread threads over per-CPU data.
+inline std::size_t current_cpu() noexcept {
+#if GENESIS_LINUX
+	auto cpu = ::sched_getcpu();
+	return cpu >= 0 ? static_cast<std::size_t>(cpu) : thread_slot();
+#elif GENESIS_MICROSOFT
+	return static_cast<std::size_t>(::GetCurrentProcessorNumber());
+#else
+	return thread_slot();
+#endif
+}
+
+} // end namespace details
+
+} // end namespace genesis
+
+#endif
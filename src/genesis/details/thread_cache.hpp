@@ -0,0 +1,103 @@
+#if !defined GENESIS_THREAD_CACHE_HEADER_INCLUDED
+#define GENESIS_THREAD_CACHE_HEADER_INCLUDED
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace genesis {
+
+namespace details {
+
+/// @brief Serializes thread caches being attached to, and detached from, their owners.
+/// Only taken when a thread first touches an owner, when a thread exits, and when an owner is destroyed.
+inline std::mutex& thread_cache_mutex() noexcept {
+	static std::mutex mutex{};
+	return mutex;
+}
+
+/// @brief The caches owned by the calling thread, one per owner it has touched. On thread exit every cache
+/// still attached is handed back to its owner.
+/// @tparam Owner The object the caches belong to. It must provide attach_cache(Cache&), which registers the
+/// cache under thread_cache_mutex(), and detach_cache(Cache&), which is called with the mutex held, takes back
+/// everything cached and clears the cache's owner.
+/// @tparam Cache Constructible from an Owner*, with a std::atomic<Owner*> owner_ that the owner clears when
+/// it is destroyed.
+template <typename Owner, typename Cache>
+class thread_cache_depot {
+private:
+	std::vector<std::unique_ptr<Cache>> caches_;
+	Cache* last_;
+
+	// Trivially destructible so it remains readable after the depot itself is gone, this lets
+	// deallocations from later thread_local destructors fall back to the owner's shared state.
+	static inline thread_local bool destroyed_{false};
+
+public:
+	thread_cache_depot() noexcept :
+		caches_{},
+		last_{nullptr}
+	{ }
+
+	thread_cache_depot(const thread_cache_depot&) = delete;
+
+	thread_cache_depot& operator=(const thread_cache_depot&) = delete;
+
+	~thread_cache_depot() {
+		destroyed_ = true;
+		std::scoped_lock lock{thread_cache_mutex()};
+		for (auto& c : caches_) {
+			if (auto* owner = c->owner_.load(std::memory_order_acquire); owner != nullptr) {
+				owner->detach_cache(*c);
+			}
+		}
+	}
+
+	/// @brief Returns the calling thread's cache for the owner, creating it on first use.
+	/// @return Cache* nullptr if the calling thread is shutting down.
+	static Cache* local(Owner* owner) {
+		if (destroyed_) { return nullptr; }
+		thread_local thread_cache_depot depot{};
+		return depot.find(owner);
+	}
+
+private:
+	Cache* find(Owner* owner) {
+		if (last_ != nullptr && last_->owner_.load(std::memory_order_acquire) == owner) {
+			return last_;
+		}
+		// Drop the caches of owners that have since been destroyed.
+		caches_.erase(
+			std::remove_if(caches_.begin(), caches_.end(), [](const auto& c) {
+				return c->owner_.load(std::memory_order_acquire) == nullptr;
+			}),
+			caches_.end()
+		);
+		last_ = nullptr;
+		for (auto& c : caches_) {
+			if (c->owner_.load(std::memory_order_acquire) == owner) {
+				last_ = c.get();
+				return last_;
+			}
+		}
+		auto& c = caches_.emplace_back(std::make_unique<Cache>(owner));
+		try {
+			owner->attach_cache(*c);
+		} catch (...) {
+			// An unregistered cache would outlive its owner.
+			caches_.pop_back();
+			throw;
+		}
+		last_ = c.get();
+		return last_;
+	}
+};
+
+} // end namespace details
+
+} // end namespace genesis
+
+#endif
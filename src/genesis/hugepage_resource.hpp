@@ -0,0 +1,307 @@
+#if !defined GENESIS_HUGEPAGE_RESOURCE_HEADER_INCLUDED
+#define GENESIS_HUGEPAGE_RESOURCE_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/config.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+#if GENESIS_POSIX
+#include <sys/mman.h>
+#include <unistd.h>
+#elif GENESIS_MICROSOFT
+#include <windows.h>
+#endif
+
+namespace genesis {
+
+/// @brief The kind of pages a hugepage_resource mapping ended up on. For transparent huge pages only the request is known.
+enum class page_backing : uint8_t {
+	/// @brief Explicit huge pages from the reserved pool, MAP_HUGETLB on Linux or large pages on Windows.
+	hugetlb,
+	/// @brief Normal pages marked with MADV_HUGEPAGE. This only records the request, the kernel backs them with
+	/// transparent huge pages as they become available and may leave any part of them on normal pages.
+	transparent_requested,
+	/// @brief Normal pages.
+	normal
+};
+
+/// @brief Construction options for hugepage_resource.
+struct hugepage_resource_options {
+	/// @brief The huge page size that mappings are aligned to and rounded up to, 2 MiB on x86_64 and most arm64 systems.
+	std::size_t huge_page_size{std::size_t{2} << 20};
+	/// @brief Allocations smaller than this go to the upstream resource rather than getting a mapping of their own.
+	std::size_t min_mapping{std::size_t{64} << 10};
+	/// @brief Try explicit huge pages first.
+	bool use_hugetlb{true};
+	/// @brief Try transparent huge pages when explicit ones are unavailable.
+	bool use_transparent{true};
+};
+
+/// @brief Snapshot of the memory currently handed out by a hugepage_resource, by backing.
+struct hugepage_resource_stats {
+	std::size_t hugetlb_bytes{0};
+	/// @brief Bytes of mappings that asked for transparent huge pages, whatever the kernel actually backed them with.
+	std::size_t transparent_requested_bytes{0};
+	std::size_t normal_bytes{0};
+	/// @brief Bytes of the small allocations passed on to the upstream resource.
+	std::size_t upstream_bytes{0};
+	std::size_t mappings{0};
+};
+
+namespace details {
+
+/// @brief Whether transparent huge pages can be requested with madvise, false if the kernel has them disabled.
+inline bool transparent_hugepages_enabled() noexcept {
+#if GENESIS_LINUX && defined MADV_HUGEPAGE
+	static const bool enabled = [] {
+		try {
+			std::ifstream file{"/sys/kernel/mm/transparent_hugepage/enabled"};
+			std::string setting{};
+			std::getline(file, setting);
+			return !setting.empty() && setting.find("[never]") == std::string::npos;
+		} catch (...) {
+			return false;
+		}
+	}();
+	return enabled;
+#else
+	return false;
+#endif
+}
+
+inline std::size_t system_page_size() noexcept {
+#if GENESIS_POSIX
+	static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	return size;
+#elif GENESIS_MICROSOFT
+	static const std::size_t size = [] {
+		SYSTEM_INFO info{};
+		::GetSystemInfo(&info);
+		return static_cast<std::size_t>(info.dwPageSize);
+	}();
+	return size;
+#else
+	return 4096;
+#endif
+}
+
+[[nodiscard]] constexpr std::size_t round_up_to(std::size_t value, std::size_t multiple) noexcept {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+} // end namespace details
+
+/// @brief The hugepage_resource class is a std::pmr::memory_resource that gives every large allocation a mapping
+/// of its own on the largest pages the system grants: explicit huge pages, then transparent huge pages, then
+/// normal pages. It cuts the TLB misses of big object_pool slabs and chunks, pass it as their mem_resource.
+/// Small allocations, such as a pool's bookkeeping, go to the upstream resource. Thread safe.
+class hugepage_resource : public std::pmr::memory_resource {
+private:
+	struct mapping {
+		void* base_;  // Start of the mapping, may precede the pointer handed out to honour its alignment
+		std::size_t length_;
+		page_backing backing_;
+	};
+
+	hugepage_resource_options options_;
+	std::pmr::memory_resource* upstream_;
+	std::mutex mutex_;
+	std::unordered_map<void*, mapping> mappings_;  // Guarded by mutex_, keyed by the pointer handed out
+	std::atomic<std::size_t> bytes_[3];  // Indexed by page_backing
+	std::atomic<std::size_t> upstream_bytes_;
+
+public:
+	/// @brief Construct a new hugepage_resource object.
+	/// @param opts The options for the resource, see hugepage_resource_options.
+	/// @param upstream The resource for allocations below opts.min_mapping.
+	explicit hugepage_resource(
+		const hugepage_resource_options& opts = {},
+		std::pmr::memory_resource* upstream = std::pmr::get_default_resource()
+	) :
+		options_{opts},
+		upstream_{upstream},
+		mutex_{},
+		mappings_{},
+		bytes_{},
+		upstream_bytes_{0}
+	{ }
+
+	/// @brief Construct a new hugepage_resource object with the default options.
+	/// @param upstream The resource for small allocations.
+	explicit hugepage_resource(std::pmr::memory_resource* upstream) :
+		hugepage_resource{hugepage_resource_options{}, upstream}
+	{ }
+
+	hugepage_resource(const hugepage_resource&) = delete;
+
+	hugepage_resource& operator=(const hugepage_resource&) = delete;
+
+	/// @brief Unmaps everything that is still allocated.
+	~hugepage_resource() override {
+		for (auto& [p, m] : mappings_) { unmap(m.base_, m.length_); }
+	}
+
+	/// @brief Upstream observor for hugepage_resource.
+	/// @return std::pmr::memory_resource* the resource serving small allocations.
+	[[nodiscard]] std::pmr::memory_resource* upstream_resource() const noexcept { return upstream_; }
+
+	/// @brief Takes a snapshot of the memory currently allocated, by backing. Explicit huge pages and normal pages
+	/// are what a mapping got, transparent huge pages are only known to have been requested.
+	/// @return hugepage_resource_stats
+	[[nodiscard]] hugepage_resource_stats stats() {
+		hugepage_resource_stats snapshot{};
+		snapshot.hugetlb_bytes = bytes_[static_cast<std::size_t>(page_backing::hugetlb)].load(std::memory_order_relaxed);
+		snapshot.transparent_requested_bytes = bytes_[static_cast<std::size_t>(page_backing::transparent_requested)].load(std::memory_order_relaxed);
+		snapshot.normal_bytes = bytes_[static_cast<std::size_t>(page_backing::normal)].load(std::memory_order_relaxed);
+		snapshot.upstream_bytes = upstream_bytes_.load(std::memory_order_relaxed);
+		std::scoped_lock lock{mutex_};
+		snapshot.mappings = mappings_.size();
+		return snapshot;
+	}
+
+	/// @brief The backing of the mapping that p was allocated from.
+	/// @param p A pointer returned by allocate.
+	/// @return page_backing normal for pointers that came from the upstream resource.
+	[[nodiscard]] page_backing backing_of(const void* p) {
+		std::scoped_lock lock{mutex_};
+		auto it = mappings_.find(const_cast<void*>(p));
+		return it != mappings_.end() ? it->second.backing_ : page_backing::normal;
+	}
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		if (bytes < options_.min_mapping) {
+			auto* p = upstream_->allocate(bytes, alignment);
+			upstream_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+			return p;
+		}
+		mapping m{};
+		void* p = map(bytes, alignment, m);
+		if (p == nullptr) { throw std::bad_alloc{}; }
+		try {
+			std::scoped_lock lock{mutex_};
+			mappings_.emplace(p, m);
+		} catch (...) {
+			unmap(m.base_, m.length_);
+			throw;
+		}
+		bytes_[static_cast<std::size_t>(m.backing_)].fetch_add(m.length_, std::memory_order_relaxed);
+		return p;
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+		if (bytes < options_.min_mapping) {
+			upstream_->deallocate(p, bytes, alignment);
+			upstream_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+			return;
+		}
+		mapping m{};
+		{
+			std::scoped_lock lock{mutex_};
+			auto it = mappings_.find(p);
+			if (it == mappings_.end()) { return; }
+			m = it->second;
+			mappings_.erase(it);
+		}
+		bytes_[static_cast<std::size_t>(m.backing_)].fetch_sub(m.length_, std::memory_order_relaxed);
+		unmap(m.base_, m.length_);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	/// @brief Maps at least bytes on the best backing available, recording what it got in m.
+	/// @return void* the aligned start of the allocation, nullptr if even normal pages could not be mapped.
+	void* map(std::size_t bytes, std::size_t alignment, mapping& m) noexcept {
+		auto huge = options_.huge_page_size;
+		if (options_.use_hugetlb && alignment <= huge) {
+			if (void* p = map_hugetlb(details::round_up_to(bytes, huge)); p != nullptr) {
+				m = {p, details::round_up_to(bytes, huge), page_backing::hugetlb};
+				return p;
+			}
+		}
+		bool transparent = options_.use_transparent && details::transparent_hugepages_enabled();
+		// Transparent huge pages need the region to cover whole, aligned huge pages.
+		auto length = transparent ? details::round_up_to(bytes, huge) : details::round_up_to(bytes, details::system_page_size());
+		auto align = std::max(alignment, transparent ? huge : details::system_page_size());
+		void* base = nullptr;
+		std::size_t mapped = 0;
+		void* p = map_aligned(length, align, base, mapped);
+		if (p == nullptr) { return nullptr; }
+		m = {base, mapped, page_backing::normal};
+#if GENESIS_LINUX && defined MADV_HUGEPAGE
+		if (transparent && ::madvise(p, length, MADV_HUGEPAGE) == 0) { m.backing_ = page_backing::transparent_requested; }
+#endif
+		return p;
+	}
+
+	[[nodiscard]] static void* map_hugetlb(std::size_t length) noexcept {
+#if GENESIS_LINUX && defined MAP_HUGETLB
+		void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		return p != MAP_FAILED ? p : nullptr;
+#elif GENESIS_MICROSOFT
+		// Needs the SeLockMemoryPrivilege, fails cleanly without it.
+		auto large = ::GetLargePageMinimum();
+		if (large == 0) { return nullptr; }
+		return ::VirtualAlloc(nullptr, details::round_up_to(length, large), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+#else
+		(void) length;
+		return nullptr;
+#endif
+	}
+
+	/// @brief Maps length bytes of normal pages aligned to align, over-mapping and trimming the excess if needed.
+	[[nodiscard]] static void* map_aligned(std::size_t length, std::size_t align, void*& base, std::size_t& mapped) noexcept {
+		auto slack = align > details::system_page_size() ? align : 0;
+#if GENESIS_POSIX
+		void* raw = ::mmap(nullptr, length + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == MAP_FAILED) { return nullptr; }
+		auto address = reinterpret_cast<std::uintptr_t>(raw);
+		auto aligned = details::round_up_to(address, align);
+		if (auto head = aligned - address; head != 0) { ::munmap(raw, head); }
+		if (auto tail = slack - (aligned - address); tail != 0) { ::munmap(reinterpret_cast<void*>(aligned + length), tail); }
+		base = reinterpret_cast<void*>(aligned);
+		mapped = length;
+		return base;
+#elif GENESIS_MICROSOFT
+		// VirtualFree can't trim a reservation, keep the whole over-sized one and hand out its aligned part.
+		void* raw = ::VirtualAlloc(nullptr, length + slack, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (raw == nullptr) { return nullptr; }
+		base = raw;
+		mapped = length + slack;
+		return reinterpret_cast<void*>(details::round_up_to(reinterpret_cast<std::uintptr_t>(raw), align));
+#else
+		(void) length;
+		(void) align;
+		(void) base;
+		(void) mapped;
+		return nullptr;
+#endif
+	}
+
+	static void unmap(void* base, std::size_t length) noexcept {
+#if GENESIS_POSIX
+		::munmap(base, length);
+#elif GENESIS_MICROSOFT
+		(void) length;
+		::VirtualFree(base, 0, MEM_RELEASE);
+#else
+		(void) base;
+		(void) length;
+#endif
+	}
+};
+
+} // end namespace genesis
+
+#endif
@@ -0,0 +1,216 @@
+#if !defined GENESIS_INPLACE_FUNCTION_HEADER_INCLUDED
+#define GENESIS_INPLACE_FUNCTION_HEADER_INCLUDED
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace genesis {
+
+/// @brief Default inline capacity of an inplace_function in bytes, room for a capture of four pointers.
+inline constexpr std::size_t inplace_function_default_capacity = 4 * sizeof(void*);
+
+template <
+	typename Signature,
+	std::size_t Capacity = inplace_function_default_capacity,
+	std::size_t Alignment = alignof(std::max_align_t)
+>
+class inplace_function;
+
+namespace details {
+
+template <typename T>
+struct is_inplace_function : std::false_type {};
+
+template <typename Signature, std::size_t Capacity, std::size_t Alignment>
+struct is_inplace_function<inplace_function<Signature, Capacity, Alignment>> : std::true_type {};
+
+enum class inplace_function_op {
+	move,
+	destroy
+};
+
+/// @brief Moves the callable from src into the raw storage at dst and destroys the original, or destroys the
+/// callable at dst. Both are independent of the capacity so functions of different capacities can share them.
+using inplace_function_manager = void(inplace_function_op op, void* dst, void* src) noexcept;
+
+template <typename Fn>
+void manage_inplace_callable(inplace_function_op op, void* dst, void* src) noexcept {
+	if (op == inplace_function_op::move) {
+		::new(dst) Fn(std::move(*static_cast<Fn*>(src)));
+		static_cast<Fn*>(src)->~Fn();
+	} else {
+		static_cast<Fn*>(dst)->~Fn();
+	}
+}
+
+} // end namespace details
+
+/// @brief The inplace_function class is a move only, type erased callable that keeps the callable in an inline
+/// buffer of Capacity bytes and never allocates. A callable that doesn't fit, or needs a stricter alignment, is
+/// a compile time error rather than a heap fallback. Calling it is a single indirect call, an empty
+/// inplace_function throws std::bad_function_call.
+/// @tparam R The return type.
+/// @tparam Args The argument types.
+/// @tparam Capacity The size of the inline buffer in bytes.
+/// @tparam Alignment The alignment of the inline buffer.
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Alignment>
+class inplace_function<R(Args...), Capacity, Alignment> {
+private:
+	using invoke_fn = R(void* storage, Args&&... args);
+
+	invoke_fn* invoke_;
+	details::inplace_function_manager* manage_;  // nullptr while empty
+	alignas(Alignment) mutable std::byte storage_[Capacity];
+
+	template <typename, std::size_t, std::size_t>
+	friend class inplace_function;
+
+public:
+	/// @brief The size of the inline buffer in bytes.
+	static constexpr std::size_t capacity = Capacity;
+	/// @brief The alignment of the inline buffer.
+	static constexpr std::size_t alignment = Alignment;
+
+	inplace_function() noexcept :
+		invoke_{&empty_invoke},
+		manage_{nullptr}
+	{ }
+
+	inplace_function(std::nullptr_t) noexcept :
+		inplace_function{}
+	{ }
+
+	/// @brief Construct a new inplace_function object holding a callable.
+	/// @tparam F The callable, it must fit the inline buffer and be nothrow move constructible.
+	/// @param f The callable to store.
+	template <
+		typename F,
+		typename Fn = std::decay_t<F>,
+		std::enable_if_t<!details::is_inplace_function<Fn>::value && std::is_invocable_r_v<R, Fn&, Args...>, int> = 0
+	>
+	inplace_function(F&& f) noexcept(std::is_nothrow_constructible_v<Fn, F>) :
+		inplace_function{}
+	{
+		emplace<Fn>(std::forward<F>(f));
+	}
+
+	/// @brief Construct a new inplace_function object from one with a buffer that is no larger and no more aligned.
+	/// @param other The inplace_function to take the callable from, it is left empty.
+	template <
+		std::size_t OtherCapacity,
+		std::size_t OtherAlignment,
+		std::enable_if_t<OtherCapacity <= Capacity && Alignment % OtherAlignment == 0, int> = 0
+	>
+	inplace_function(inplace_function<R(Args...), OtherCapacity, OtherAlignment>&& other) noexcept :
+		invoke_{std::exchange(other.invoke_, &empty_invoke)},
+		manage_{std::exchange(other.manage_, nullptr)}
+	{
+		if (manage_ != nullptr) { manage_(details::inplace_function_op::move, storage_, other.storage_); }
+	}
+
+	inplace_function(const inplace_function&) = delete;
+
+	inplace_function(inplace_function&& other) noexcept :
+		invoke_{std::exchange(other.invoke_, &empty_invoke)},
+		manage_{std::exchange(other.manage_, nullptr)}
+	{
+		if (manage_ != nullptr) { manage_(details::inplace_function_op::move, storage_, other.storage_); }
+	}
+
+	inplace_function& operator=(const inplace_function&) = delete;
+
+	inplace_function& operator=(inplace_function&& other) noexcept {
+		if (this != &other) {
+			reset();
+			invoke_ = std::exchange(other.invoke_, &empty_invoke);
+			manage_ = std::exchange(other.manage_, nullptr);
+			if (manage_ != nullptr) { manage_(details::inplace_function_op::move, storage_, other.storage_); }
+		}
+		return *this;
+	}
+
+	inplace_function& operator=(std::nullptr_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	template <
+		typename F,
+		typename Fn = std::decay_t<F>,
+		std::enable_if_t<!details::is_inplace_function<Fn>::value && std::is_invocable_r_v<R, Fn&, Args...>, int> = 0
+	>
+	inplace_function& operator=(F&& f) noexcept(std::is_nothrow_constructible_v<Fn, F>) {
+		reset();
+		emplace<Fn>(std::forward<F>(f));
+		return *this;
+	}
+
+	~inplace_function() { reset(); }
+
+	/// @brief Invokes the stored callable.
+	/// @return R whatever the callable returns.
+	R operator()(Args... args) const { return invoke_(storage_, std::forward<Args>(args)...); }
+
+	explicit operator bool() const noexcept { return manage_ != nullptr; }
+
+	void swap(inplace_function& other) noexcept {
+		if (this == &other) { return; }
+		inplace_function tmp{std::move(other)};
+		other = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	friend void swap(inplace_function& lhs, inplace_function& rhs) noexcept { lhs.swap(rhs); }
+
+	friend bool operator==(const inplace_function& f, std::nullptr_t) noexcept { return !f; }
+
+	friend bool operator==(std::nullptr_t, const inplace_function& f) noexcept { return !f; }
+
+	friend bool operator!=(const inplace_function& f, std::nullptr_t) noexcept { return static_cast<bool>(f); }
+
+	friend bool operator!=(std::nullptr_t, const inplace_function& f) noexcept { return static_cast<bool>(f); }
+
+private:
+	/// @brief Stores a callable in the empty buffer, leaving the function empty if its constructor throws.
+	template <typename Fn, typename F>
+	void emplace(F&& f) noexcept(std::is_nothrow_constructible_v<Fn, F>) {
+		static_assert(sizeof(Fn) <= Capacity, "inplace_function callable is larger than its capacity");
+		static_assert(Alignment % alignof(Fn) == 0, "inplace_function callable needs a stricter alignment");
+		static_assert(std::is_nothrow_move_constructible_v<Fn>, "inplace_function callable must be nothrow move constructible");
+		if constexpr (std::is_pointer_v<std::remove_reference_t<F>> || std::is_member_pointer_v<std::remove_reference_t<F>>) {
+			// A null function pointer makes an empty function, as it does for std::function. A function reference
+			// decays to a pointer in Fn but can never be null, so it isn't compared.
+			if (f == nullptr) { return; }
+		}
+		::new(static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+		invoke_ = &invoke_callable<Fn>;
+		manage_ = &details::manage_inplace_callable<Fn>;
+	}
+
+	void reset() noexcept {
+		if (manage_ != nullptr) {
+			manage_(details::inplace_function_op::destroy, storage_, nullptr);
+			manage_ = nullptr;
+			invoke_ = &empty_invoke;
+		}
+	}
+
+	[[noreturn]] static R empty_invoke(void*, Args&&...) { throw std::bad_function_call{}; }
+
+	template <typename Fn>
+	static R invoke_callable(void* storage, Args&&... args) {
+		if constexpr (std::is_void_v<R>) {
+			std::invoke(*static_cast<Fn*>(storage), std::forward<Args>(args)...);
+		} else {
+			return std::invoke(*static_cast<Fn*>(storage), std::forward<Args>(args)...);
+		}
+	}
+};
+
+} // end namespace genesis
+
+#endif
@@ -2,6 +2,12 @@
 #define GENESIS_MEMORY_HEADER_INCLUDED
 #pragma once
 
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 namespace genesis {
@@ -15,6 +21,200 @@ constexpr auto construct_at(T* location, Args&&... args) noexcept(
 	return ::new((void*)location) T(std::forward<Args>(args)...);
 }
 
+namespace details {
+
+/// @brief Whether a T built from a const V& can be stamped out by copying the bytes of a single prototype.
+template <typename T, typename V>
+inline constexpr bool is_bytewise_fillable_v =
+	std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T> && std::is_nothrow_constructible_v<T, const V&>;
+
+/// @brief Fills count objects starting at first with the bytes of prototype, in one memset when they are all equal.
+template <typename T>
+void fill_bytes(T* first, std::size_t count, const T& prototype) noexcept {
+	const auto* bytes = reinterpret_cast<const unsigned char*>(std::addressof(prototype));
+	bool uniform = true;
+	for (std::size_t i = 1; i < sizeof(T); ++i) { uniform = uniform && bytes[i] == bytes[0]; }
+	if (uniform) {
+		std::memset(static_cast<void*>(first), bytes[0], count * sizeof(T));
+	} else {
+		for (std::size_t i = 0; i < count; ++i) { std::memcpy(static_cast<void*>(first + i), bytes, sizeof(T)); }
+	}
+}
+
+} // end namespace details
+
+/// @brief Default constructs n objects in the uninitialized storage starting at first, a no-op for trivially
+/// default constructible types. If a constructor throws, the objects already constructed are destroyed.
+/// @param first Start of the uninitialized storage.
+/// @param n The number of objects to construct.
+/// @return ForwardIt the end of the constructed range.
+template <typename ForwardIt, typename Size>
+ForwardIt uninitialized_default_construct_n(ForwardIt first, Size n) {
+	using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+	if constexpr (std::is_trivially_default_constructible_v<value_type>) {
+		return std::next(first, n);
+	} else {
+		auto current = first;
+		try {
+			for (; n > 0; --n, (void)++current) { ::new(static_cast<void*>(std::addressof(*current))) value_type; }
+		} catch (...) {
+			std::destroy(first, current);
+			throw;
+		}
+		return current;
+	}
+}
+
+/// @brief Fills n objects in the uninitialized storage starting at first with copies of value. Trivially copyable
+/// results are stamped out from one prototype, with a single memset when its bytes are all equal, such as zero or
+/// all ones. If a constructor throws, the objects already constructed are destroyed.
+/// @param first Start of the uninitialized storage.
+/// @param n The number of objects to construct.
+/// @param value The value to construct every object from.
+/// @return ForwardIt the end of the constructed range.
+template <typename ForwardIt, typename Size, typename V>
+ForwardIt uninitialized_fill_n(ForwardIt first, Size n, const V& value) {
+	using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+	if constexpr (std::is_pointer_v<ForwardIt> && details::is_bytewise_fillable_v<value_type, V>) {
+		if (n > 0) {
+			alignas(value_type) unsigned char storage[sizeof(value_type)];
+			auto* prototype = ::new(static_cast<void*>(storage)) value_type(value);
+			details::fill_bytes(first, static_cast<std::size_t>(n), *prototype);
+		}
+		return first + (n > 0 ? n : 0);
+	} else {
+		auto current = first;
+		try {
+			for (; n > 0; --n, (void)++current) { ::new(static_cast<void*>(std::addressof(*current))) value_type(value); }
+		} catch (...) {
+			std::destroy(first, current);
+			throw;
+		}
+		return current;
+	}
+}
+
+/// @brief Value initializes n objects in the uninitialized storage starting at first, lowered to
+/// uninitialized_fill_n of a value initialized prototype for trivial types, so zero initialization is one memset.
+/// If a constructor throws, the objects already constructed are destroyed.
+/// @param first Start of the uninitialized storage.
+/// @param n The number of objects to construct.
+/// @return ForwardIt the end of the constructed range.
+template <typename ForwardIt, typename Size>
+ForwardIt uninitialized_value_construct_n(ForwardIt first, Size n) {
+	using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+	if constexpr (std::is_trivial_v<value_type>) {
+		return genesis::uninitialized_fill_n(first, n, value_type());
+	} else {
+		auto current = first;
+		try {
+			for (; n > 0; --n, (void)++current) { ::new(static_cast<void*>(std::addressof(*current))) value_type(); }
+		} catch (...) {
+			std::destroy(first, current);
+			throw;
+		}
+		return current;
+	}
+}
+
+/// @brief Destroys the n objects starting at first, a no-op for trivially destructible types.
+/// @param first Start of the objects to destroy.
+/// @param n The number of objects to destroy.
+/// @return ForwardIt the end of the destroyed range.
+template <typename ForwardIt, typename Size>
+ForwardIt destroy_n(ForwardIt first, Size n) noexcept {
+	using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+	if constexpr (std::is_trivially_destructible_v<value_type>) {
+		return std::next(first, n);
+	} else {
+		for (; n > 0; --n, (void)++first) { std::destroy_at(std::addressof(*first)); }
+		return first;
+	}
+}
+
+/// @brief Whether moving a T to new storage and ending the lifetime of the original is equivalent to copying its
+/// bytes and forgetting the original. True for trivially copyable types and the std smart pointers, other types
+/// opt in by specializing it. Most types that own their memory through a pointer qualify, types that point into
+/// themselves, such as std::string with its inline buffer in libstdc++, must not.
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename Deleter>
+struct is_trivially_relocatable<std::unique_ptr<T, Deleter>> : is_trivially_relocatable<Deleter> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+/// @brief Moves the object at source into the uninitialized storage at dest and ends the lifetime of the original,
+/// with a single memcpy when T is trivially relocatable.
+/// @param source The object to relocate, left as raw storage.
+/// @param dest Uninitialized storage for a T, not overlapping source.
+/// @return T* the relocated object.
+template <typename T>
+T* relocate_at(T* source, T* dest) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+	if constexpr (is_trivially_relocatable_v<T>) {
+		std::memcpy(static_cast<void*>(dest), static_cast<const void*>(source), sizeof(T));
+		return std::launder(dest);
+	} else {
+		auto* relocated = ::new(static_cast<void*>(dest)) T(std::move(*source));
+		source->~T();
+		return relocated;
+	}
+}
+
+/// @brief Relocates the n objects starting at first into the uninitialized storage starting at d_first, with a
+/// single memmove when both are pointers to the same trivially relocatable type. The destination may overlap the
+/// source only if it starts before it. If a move constructor throws, every object left in either range is destroyed.
+/// @param first Start of the objects to relocate, left as raw storage.
+/// @param n The number of objects to relocate.
+/// @param d_first Start of the uninitialized destination storage.
+/// @return std::pair<InputIt, ForwardIt> the ends of the source and destination ranges.
+template <typename InputIt, typename Size, typename ForwardIt>
+std::pair<InputIt, ForwardIt> uninitialized_relocate_n(InputIt first, Size n, ForwardIt d_first) {
+	using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+	if constexpr (
+		std::is_pointer_v<InputIt> && std::is_pointer_v<ForwardIt> &&
+		std::is_same_v<std::remove_cv_t<typename std::iterator_traits<InputIt>::value_type>, value_type> &&
+		is_trivially_relocatable_v<value_type>
+	) {
+		if (n > 0) {
+			std::memmove(static_cast<void*>(d_first), static_cast<const void*>(first), static_cast<std::size_t>(n) * sizeof(value_type));
+		}
+		return {first + n, d_first + n};
+	} else {
+		auto current = d_first;
+		try {
+			for (; n > 0; --n, (void)++first, (void)++current) {
+				::new(static_cast<void*>(std::addressof(*current))) value_type(std::move(*first));
+				std::destroy_at(std::addressof(*first));
+			}
+		} catch (...) {
+			// The move that threw left its source alive, so all n remaining sources are destroyed.
+			std::destroy(d_first, current);
+			std::destroy_n(first, n);
+			throw;
+		}
+		return {first, current};
+	}
+}
+
+/// @brief Relocates the objects of [first, last) into the uninitialized storage starting at d_first, see
+/// uninitialized_relocate_n.
+/// @param first Start of the objects to relocate, left as raw storage.
+/// @param last End of the objects to relocate.
+/// @param d_first Start of the uninitialized destination storage.
+/// @return ForwardIt the end of the destination range.
+template <typename InputIt, typename ForwardIt>
+ForwardIt uninitialized_relocate(InputIt first, InputIt last, ForwardIt d_first) {
+	return uninitialized_relocate_n(first, std::distance(first, last), d_first).second;
+}
+
 } // end namespace genesis
 
-#endif
\ No newline at end of file
+#endif
@@ -2,38 +2,466 @@
 #define GENESIS_OBJECT_POOL_HEADER_INCLUDED
 #pragma once
 
+#include "genesis/details/atomic_wait.hpp"
+#include "genesis/details/thread.hpp"
+#include "genesis/details/thread_cache.hpp"
 #include "genesis/memory.hpp"
+#include "genesis/spin_wait.hpp"
+#include "genesis/stop_token.hpp"
+#include "genesis/utility.hpp"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
-#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <memory_resource>
 #include <mutex>
 #include <optional>
+#include <stdexcept>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+// Define GENESIS_OBJECT_POOL_STATS to 1, identically in every translation unit, to have object pools collect
+// the counters reported by object_pool::stats. Left at 0 the counting compiles away entirely.
+#if !defined GENESIS_OBJECT_POOL_STATS
+#define GENESIS_OBJECT_POOL_STATS 0
+#endif
+
 namespace genesis {
 
-template <typename T>
+/// @brief Concurrency policy for an object_pool that is only ever used by one thread. Borrowing and returning
+/// compile down to a plain intrusive stack, there is nothing to wait for and nothing to synchronize.
+struct pool_single_thread {};
+
+/// @brief Concurrency policy for an object_pool with one borrowing thread and one returning thread, which may be
+/// the same thread. Returned objects pass through a ring of indices that only needs release and acquire stores.
+struct pool_spsc {};
+
+/// @brief Concurrency policy for an object_pool that any number of threads borrow from and return to concurrently.
+struct pool_mpmc {};
+
+template <typename T, typename Concurrency = pool_mpmc>
 class object_pool;
 
+template <typename T, typename Concurrency = pool_mpmc>
+class pool_ptr;
+
+template <typename T>
+class sharded_object_pool;
+
+/// @brief How an object_pool adds capacity once it runs dry.
+enum class pool_growth : uint8_t {
+	/// @brief Adds a single chunk at a time.
+	linear,
+	/// @brief Adds as many chunks as it takes to roughly double the current capacity.
+	geometric
+};
+
+/// @brief When an object_pool constructs the objects of its initial capacity.
+enum class pool_construction : uint8_t {
+	/// @brief Constructs every object with the generator up front.
+	eager,
+	/// @brief Reserves the storage up front and constructs each object with the generator the first time it is
+	/// borrowed. Storage that was never borrowed is never written to, so it costs no resident memory.
+	lazy
+};
+
+/// @brief What an object_pool does with an object that is returned to it.
+enum class pool_recycle : uint8_t {
+	/// @brief Keeps the object exactly as the borrower left it, only the check for the policy is left on the hot path.
+	as_is,
+	/// @brief Calls the reset hook on the returning thread.
+	reset_on_return,
+	/// @brief Calls the reset hook on the borrowing thread, right before the object is handed out again.
+	reset_on_borrow,
+	/// @brief Destroys the object and constructs a new one with the generator on the returning thread.
+	reconstruct
+};
+
+/// @brief Which borrower gets an object that is returned while the pool is exhausted.
+enum class pool_fairness : uint8_t {
+	/// @brief The object goes back on the freelist and a waiter is woken, any borrower may take it first.
+	barging,
+	/// @brief Waiters queue in arrival order and a returned object is handed straight to the oldest one.
+	fifo
+};
+
+/// @brief Whether object_pool<T> keeps its freelist head, its waiter count and its stats counters each on cache
+/// lines of their own. Specialize to std::false_type for pools that are numerous and rarely contended, where the
+/// padding costs more memory than the false sharing it prevents is worth.
+template <typename T>
+struct object_pool_padding : std::true_type {};
+
+template <typename T>
+inline constexpr bool object_pool_padding_v = object_pool_padding<T>::value;
+
+/// @brief Construction options for object_pool.
+struct object_pool_options {
+	/// @brief The number of objects the pool holds, must be less than 2^32 - 1.
+	std::size_t capacity{0};
+	/// @brief The number of nodes each thread may cache locally, 0 disables the per-thread magazines.
+	/// Nodes cached by one thread are not visible to other threads until they are spilled back, so up to
+	/// (threads * magazine_size) objects may be stranded when the pool runs dry.
+	std::size_t magazine_size{0};
+	/// @brief The capacity the pool may grow to in chunks, anything at or below capacity keeps the pool fixed size.
+	/// Four bytes of freelist links are reserved per object up to this limit, and once the pool hands out its
+	/// first std::shared_ptr another details::control_block_size bytes for the control blocks.
+	std::size_t max_capacity{0};
+	/// @brief The number of objects per growth chunk, 0 uses capacity (or 64 for an initially empty pool).
+	std::size_t chunk_size{0};
+	/// @brief How many chunks are added each time the pool runs dry.
+	pool_growth growth{pool_growth::linear};
+	/// @brief How long a grown chunk must sit entirely unused before it is released back to the memory resource.
+	/// The initial capacity is never released, the default never releases anything.
+	std::chrono::milliseconds idle_release{std::chrono::milliseconds::max()};
+	/// @brief When the objects of the initial capacity are constructed, grown chunks are always built eagerly.
+	pool_construction construction{pool_construction::eager};
+	/// @brief What happens to a returned object, the reset policies need a reset hook or a T::reset() member.
+	pool_recycle recycle{pool_recycle::as_is};
+	/// @brief How returned objects are shared out among blocked borrowers, only pool_mpmc pools wait in line.
+	/// With fifo a node whose reconstruction failed is rebuilt by the next borrower that doesn't wait.
+	pool_fairness fairness{pool_fairness::barging};
+};
+
+/// @brief Snapshot of the counters of an object_pool, all zero unless GENESIS_OBJECT_POOL_STATS is 1.
+/// The counters are read one after another while the pool is in use, so they are only roughly consistent.
+struct object_pool_stats {
+	/// @brief Number of buckets in the wait time histogram.
+	static constexpr std::size_t wait_buckets = 16;
+
+	/// @brief The number of objects the pool holds.
+	std::size_t capacity{0};
+	/// @brief The number of objects borrowed right now.
+	std::size_t borrowed{0};
+	/// @brief The most objects seen borrowed at once, sampled every so often and whenever the pool runs dry.
+	std::size_t high_water{0};
+	/// @brief The number of successful borrows.
+	uint64_t borrows{0};
+	/// @brief The number of objects returned.
+	uint64_t returns{0};
+	/// @brief The number of failed compare-exchanges on the freelist head.
+	uint64_t cas_retries{0};
+	/// @brief The number of borrows that had to wait for an object to be returned.
+	uint64_t waits{0};
+	/// @brief The number of borrows that came back empty, after a timeout, a stop request or without waiting.
+	uint64_t failures{0};
+	/// @brief How long the waiting borrows waited, bucket i counts waits shorter than wait_bucket_bound(i).
+	std::array<uint64_t, wait_buckets> wait_histogram{};
+
+	/// @brief The exclusive upper bound of a wait time bucket, each bucket is four times as wide as the one
+	/// before it. The last bucket counts everything from the bound of the one before it upwards.
+	[[nodiscard]] static constexpr std::chrono::microseconds wait_bucket_bound(std::size_t bucket) noexcept {
+		return bucket + 1 < wait_buckets ? std::chrono::microseconds{int64_t{1} << (2 * bucket)} : std::chrono::microseconds::max();
+	}
+
+	object_pool_stats& operator+=(const object_pool_stats& other) noexcept {
+		capacity += other.capacity;
+		borrowed += other.borrowed;
+		high_water += other.high_water;
+		borrows += other.borrows;
+		returns += other.returns;
+		cas_retries += other.cas_retries;
+		waits += other.waits;
+		failures += other.failures;
+		for (std::size_t i = 0; i < wait_buckets; ++i) { wait_histogram[i] += other.wait_histogram[i]; }
+		return *this;
+	}
+};
+
 namespace details {
 
+/// @brief Bytes reserved per node for the control block of the std::shared_ptr handed out by
+/// object_pool::allocate, so borrowing through a std::shared_ptr never touches the heap.
+inline constexpr std::size_t control_block_size = 8 * sizeof(void*);
+
+/// @brief Least alignment of a block of pool nodes, the size of a cache line.
+inline constexpr std::size_t slab_alignment = hardware_destructive_interference_size;
+
+/// @brief Freelist links are 32-bit node indices, npos marks the end of a list.
+inline constexpr uint32_t npos_index = UINT32_MAX;
+
+template <typename T, typename = void>
+struct has_reset : std::false_type {};
+
+template <typename T>
+struct has_reset<T, std::void_t<decltype(std::declval<T&>().reset())>> : std::true_type {};
+
+/// @brief The reset hook an object_pool uses when none is given, calls T::reset() if T has one.
 template <typename T>
+[[nodiscard]] std::function<void(T&)> default_reset() {
+	if constexpr (has_reset<T>::value) {
+		return [](T& obj) { obj.reset(); };
+	} else {
+		return {};
+	}
+}
+
+/// @brief The freelist links of a pool, one per node index. Allocated from the pool's memory resource, or
+/// placed in storage that the owner of the pool provides.
+class link_table {
+private:
+	std::pmr::memory_resource* resource_;  // nullptr if the links live in borrowed storage
+	std::atomic<uint32_t>* links_;
+	std::size_t size_;
+
+public:
+	link_table(std::size_t init_size, std::pmr::memory_resource* resource, std::atomic<uint32_t>* storage) :
+		resource_{storage == nullptr && init_size != 0 ? resource : nullptr},
+		links_{storage},
+		size_{init_size}
+	{
+		if (resource_ != nullptr) {
+			links_ = static_cast<std::atomic<uint32_t>*>(resource_->allocate(size_ * sizeof(std::atomic<uint32_t>), alignof(std::atomic<uint32_t>)));
+		}
+		// npos_index is all ones, so this is a single memset.
+		genesis::uninitialized_fill_n(links_, size_, npos_index);
+	}
+
+	link_table(const link_table&) = delete;
+
+	link_table& operator=(const link_table&) = delete;
+
+	~link_table() {
+		if (resource_ != nullptr) {
+			resource_->deallocate(links_, size_ * sizeof(std::atomic<uint32_t>), alignof(std::atomic<uint32_t>));
+		}
+	}
+
+	std::atomic<uint32_t>& operator[](std::size_t index) noexcept { return links_[index]; }
+
+	const std::atomic<uint32_t>& operator[](std::size_t index) const noexcept { return links_[index]; }
+
+	[[nodiscard]] std::size_t size() const noexcept { return size_; }
+};
+
+/// @brief Ring of node indices handed from the returning thread to the borrowing thread of a pool_spsc pool.
+/// Each side only ever stores to its own position, so a push or pop is a release store after an acquire load.
+/// One more slot than the pool has nodes means the ring can never fill up.
+class spsc_ring {
+private:
+	link_table slots_;
+	cache_padded<std::atomic<std::size_t>> head_;  // Next slot to pop, written by the borrower only
+	cache_padded<std::atomic<std::size_t>> tail_;  // Next slot to push, written by the returner only
+
+public:
+	spsc_ring(std::size_t init_size, std::pmr::memory_resource* resource, std::atomic<uint32_t>* storage) :
+		slots_{init_size, resource, storage},
+		head_{0},
+		tail_{0}
+	{ }
+
+	void push(uint32_t index) noexcept {
+		auto tail = tail_->load(std::memory_order_relaxed);
+		slots_[tail].store(index, std::memory_order_relaxed);
+		tail_->store(advance(tail), std::memory_order_release);
+	}
+
+	/// @return uint32_t the oldest index in the ring, npos_index if the ring is empty.
+	[[nodiscard]] uint32_t pop() noexcept {
+		auto head = head_->load(std::memory_order_relaxed);
+		if (head == tail_->load(std::memory_order_acquire)) { return npos_index; }
+		auto index = slots_[head].load(std::memory_order_relaxed);
+		head_->store(advance(head), std::memory_order_release);
+		return index;
+	}
+
+private:
+	[[nodiscard]] std::size_t advance(std::size_t position) const noexcept {
+		return position + 1 == slots_.size() ? 0 : position + 1;
+	}
+};
+
+/// @brief Stand in for spsc_ring in pools with any other concurrency policy.
+struct no_spsc_ring {
+	no_spsc_ring(std::size_t, std::pmr::memory_resource*, std::atomic<uint32_t>*) noexcept { }
+};
+
+/// @brief Stand in for cache_padded in object pools that opted out through object_pool_padding.
+template <typename T>
+struct unpadded {
+	T value;
+
+	template <
+		typename... Args,
+		std::enable_if_t<std::is_constructible_v<T, Args...>, int> = 0
+	>
+	constexpr explicit unpadded(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) :
+		value(std::forward<Args>(args)...)
+	{ }
+
+	constexpr T& operator*() noexcept { return value; }
+
+	constexpr const T& operator*() const noexcept { return value; }
+
+	constexpr T* operator->() noexcept { return &value; }
+
+	constexpr const T* operator->() const noexcept { return &value; }
+};
+
+template <typename T, bool Padded>
+using padded_if = std::conditional_t<Padded, cache_padded<T>, unpadded<T>>;
+
+/// @brief One set of counters, threads are spread over several of them so counting adds no contention of its own.
+template <bool Padded>
+struct alignas(Padded ? hardware_destructive_interference_size : alignof(std::atomic<uint64_t>)) pool_counter_slot {
+	std::atomic<uint64_t> borrows{0};
+	std::atomic<uint64_t> returns{0};
+	std::atomic<uint64_t> cas_retries{0};
+	std::atomic<uint64_t> waits{0};
+	std::atomic<uint64_t> failures{0};
+	std::array<std::atomic<uint64_t>, object_pool_stats::wait_buckets> wait_histogram{};
+};
+
+/// @brief The counters behind object_pool_stats, used when GENESIS_OBJECT_POOL_STATS is 1.
+template <bool Padded>
+class pool_counters {
+private:
+	using slot_type = pool_counter_slot<Padded>;
+
+	static constexpr std::size_t slot_count = 16;
+	// A thread folds its borrowed count into the high water mark once per this many borrows.
+	static constexpr uint64_t high_water_interval = 64;
+
+	std::array<slot_type, slot_count> slots_{};
+	std::atomic<std::size_t> high_water_{0};
+
+	[[nodiscard]] slot_type& local() noexcept { return slots_[thread_slot() % slot_count]; }
+
+	template <typename Member>
+	[[nodiscard]] uint64_t sum(Member member) const noexcept {
+		uint64_t total = 0;
+		for (const auto& slot : slots_) { total += (slot.*member).load(std::memory_order_relaxed); }
+		return total;
+	}
+
+	[[nodiscard]] std::size_t borrowed() const noexcept {
+		auto borrows = sum(&slot_type::borrows);
+		auto returns = sum(&slot_type::returns);
+		return borrows > returns ? static_cast<std::size_t>(borrows - returns) : 0;
+	}
+
+public:
+	void borrowed(uint64_t count) noexcept {
+		auto& slot = local();
+		auto before = slot.borrows.fetch_add(count, std::memory_order_relaxed);
+		if (before / high_water_interval != (before + count) / high_water_interval) { sample_high_water(); }
+	}
+
+	void returned(uint64_t count) noexcept { local().returns.fetch_add(count, std::memory_order_relaxed); }
+
+	void cas_retry() noexcept { local().cas_retries.fetch_add(1, std::memory_order_relaxed); }
+
+	void failed() noexcept {
+		local().failures.fetch_add(1, std::memory_order_relaxed);
+		sample_high_water();
+	}
+
+	void waited(std::chrono::steady_clock::duration wait_time) noexcept {
+		auto& slot = local();
+		slot.waits.fetch_add(1, std::memory_order_relaxed);
+		std::size_t bucket = 0;
+		while (bucket + 1 < object_pool_stats::wait_buckets && wait_time >= object_pool_stats::wait_bucket_bound(bucket)) { ++bucket; }
+		slot.wait_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void sample_high_water() noexcept {
+		auto now = borrowed();
+		auto high = high_water_.load(std::memory_order_relaxed);
+		while (now > high && !high_water_.compare_exchange_weak(high, now, std::memory_order_relaxed)) { }
+	}
+
+	void snapshot(object_pool_stats& stats) noexcept {
+		sample_high_water();
+		stats.borrowed = borrowed();
+		stats.high_water = high_water_.load(std::memory_order_relaxed);
+		stats.borrows = sum(&slot_type::borrows);
+		stats.returns = sum(&slot_type::returns);
+		stats.cas_retries = sum(&slot_type::cas_retries);
+		stats.waits = sum(&slot_type::waits);
+		stats.failures = sum(&slot_type::failures);
+		for (const auto& slot : slots_) {
+			for (std::size_t i = 0; i < object_pool_stats::wait_buckets; ++i) {
+				stats.wait_histogram[i] += slot.wait_histogram[i].load(std::memory_order_relaxed);
+			}
+		}
+	}
+};
+
+/// @brief Stand in for pool_counters when GENESIS_OBJECT_POOL_STATS is 0, every call compiles to nothing.
+struct no_pool_counters {
+	void borrowed(uint64_t) noexcept { }
+	void returned(uint64_t) noexcept { }
+	void cas_retry() noexcept { }
+	void failed() noexcept { }
+	void waited(std::chrono::steady_clock::duration) noexcept { }
+	void snapshot(object_pool_stats&) noexcept { }
+};
+
+/// @brief Packs a node index together with a generation tag into a single 64-bit word.
+/// The tag is bumped on every successful update of a freelist head, so a head that was popped and pushed
+/// back in between a load and a compare-exchange no longer compares equal (the Treiber stack ABA problem).
+struct tagged_index {
+	uint32_t index;
+	uint32_t tag;
+
+	[[nodiscard]] static constexpr tagged_index unpack(uint64_t word) noexcept {
+		return {static_cast<uint32_t>(word), static_cast<uint32_t>(word >> 32)};
+	}
+
+	[[nodiscard]] constexpr uint64_t pack() const noexcept {
+		return static_cast<uint64_t>(tag) << 32 | index;
+	}
+
+	/// @brief The word that replaces this head, pointing at new_index with the next generation.
+	[[nodiscard]] constexpr uint64_t next(uint32_t new_index) const noexcept {
+		return tagged_index{new_index, tag + 1}.pack();
+	}
+};
+
+/// @brief Header in front of every block of nodes, the slab as well as each grown chunk. A node finds it from
+/// its own address and its offset in the block, so it needs no pointer back to its pool.
+template <typename Pool>
+struct pool_block {
+	Pool* home_;
+	uint32_t first_;  // Index of the first node in the block
+};
+
+template <typename T, typename Concurrency = pool_mpmc>
 class pool_node {
+public:
+	using block = pool_block<object_pool<T, Concurrency>>;
+
 private:
-	pool_node* next_;
-	object_pool<T>* home_;
+	uint32_t offset_;  // Position in the node's block
 	alignas(T) std::byte data_[sizeof(T)];  // Raw storage for T
 
 public:
-	pool_node(object_pool<T>* init_home, pool_node* init_next) noexcept :
-		home_{init_home},
-		next_{init_next}
+	explicit pool_node(uint32_t init_offset) noexcept :
+		offset_{init_offset}
 	{ }
 
+	/// @brief Alignment of a block of nodes, keeps the first node on its own cache line.
+	[[nodiscard]] static constexpr std::size_t block_alignment() noexcept {
+		return std::max(alignof(pool_node), slab_alignment);
+	}
+
+	/// @brief Bytes taken by the header in front of the first node, a whole cache line so nodes never share
+	/// one with the header that every return reads.
+	[[nodiscard]] static constexpr std::size_t block_header_size() noexcept {
+		return (sizeof(block) + block_alignment() - 1) / block_alignment() * block_alignment();
+	}
+
+	/// @brief Bytes taken by a block of count nodes, header included.
+	[[nodiscard]] static constexpr std::size_t block_size(std::size_t count) noexcept {
+		return block_header_size() + count * sizeof(pool_node);
+	}
+
 	pool_node(const pool_node&) = delete;
 
 	pool_node(pool_node&&) = delete;
@@ -42,8 +470,6 @@ public:
 
 	pool_node& operator=(pool_node&&) = delete;
 
-	[[nodiscard]] pool_node* link(pool_node* next) noexcept { next_ = next; return next; }
-
 	T& operator*() noexcept { return *std::launder(reinterpret_cast<T*>(data_)); }
 
 	const T& operator*() const noexcept { return *std::launder(reinterpret_cast<const T*>(data_)); }
@@ -56,13 +482,9 @@ public:
 
 	[[nodiscard]] const T* data() const noexcept { return std::launder(reinterpret_cast<const T*>(data_)); }
 
-	[[nodiscard]] object_pool<T>* home() noexcept { return home_; }
-
-	void next(pool_node* n) noexcept { next_ = n; }
+	[[nodiscard]] object_pool<T, Concurrency>* home() const noexcept { return header()->home_; }
 
-	[[nodiscard]] pool_node* next() noexcept { return next_; }
-
-	[[nodiscard]] const pool_node* next() const noexcept { return next_; }
+	[[nodiscard]] uint32_t index() const noexcept { return header()->first_ + offset_; }
 
 	template <typename... Args>
 	void construct(Args&&... args) {
@@ -73,7 +495,164 @@ public:
 		std::destroy_at(std::launder(reinterpret_cast<T*>(data_)));
 	}
 
-	friend class object_pool<T>;
+private:
+	[[nodiscard]] const block* header() const noexcept {
+		auto* base = reinterpret_cast<const std::byte*>(this) - std::size_t{offset_} * sizeof(pool_node) - block_header_size();
+		return std::launder(reinterpret_cast<const block*>(base));
+	}
+
+	friend class object_pool<T, Concurrency>;
+};
+
+/// @brief A block of nodes added to a pool after construction.
+template <typename Node>
+struct pool_chunk {
+	/// @brief The chunk's nodes, nullptr while the chunk is not allocated.
+	std::atomic<Node*> nodes_{nullptr};
+	/// @brief Number of the chunk's nodes found on the freelist by the last trim.
+	std::size_t free_{0};
+	/// @brief When the chunk was first seen entirely free, the epoch while any node is borrowed.
+	std::chrono::steady_clock::time_point idle_since_{};
+};
+
+/// @brief Allocator that places a std::shared_ptr control block in the slot its pool keeps for the node.
+/// The node is handed back to its pool once the control block is destroyed, rather than from the deleter,
+/// so the storage is never reused while the last owner or an outstanding std::weak_ptr still refers to it.
+template <typename U, typename Node>
+struct control_block_allocator {
+	using value_type = U;
+
+	Node* node_;
+
+	explicit control_block_allocator(Node* init_node) noexcept :
+		node_{init_node}
+	{ }
+
+	template <typename V>
+	control_block_allocator(const control_block_allocator<V, Node>& other) noexcept :
+		node_{other.node_}
+	{ }
+
+	template <typename V>
+	struct rebind {
+		using other = control_block_allocator<V, Node>;
+	};
+
+	[[nodiscard]] U* allocate(std::size_t n) noexcept {
+		static_assert(sizeof(U) <= control_block_size, "std::shared_ptr control block does not fit in the pool node");
+		static_assert(alignof(U) <= alignof(std::max_align_t), "std::shared_ptr control block is over aligned");
+		(void) n;
+		return reinterpret_cast<U*>(node_->home()->control_block(node_->index()));
+	}
+
+	void deallocate(U*, std::size_t) noexcept { node_->home()->deallocate(node_); }
+
+	template <typename V>
+	friend bool operator==(const control_block_allocator& a, const control_block_allocator<V, Node>& b) noexcept {
+		return a.node_ == b.node_;
+	}
+
+	template <typename V>
+	friend bool operator!=(const control_block_allocator& a, const control_block_allocator<V, Node>& b) noexcept {
+		return a.node_ != b.node_;
+	}
+};
+
+/// @brief Deleter for pooled std::shared_ptr's, objects stay constructed while they sit in the pool.
+struct keep_alive_deleter {
+	template <typename T>
+	void operator()(T*) const noexcept { }
+};
+
+/// @brief A borrower blocked in a fifo pool, it lives on the waiting thread's stack while queued.
+template <typename Node>
+struct pool_waiter {
+	std::atomic<Node*> handed_{nullptr};  // Set by the returning thread that picked this waiter
+	std::atomic<uint32_t> signal_{0};  // Bumped on handoff and on stop, the waiter parks on this word
+	pool_waiter* prev_{nullptr};
+	pool_waiter* next_{nullptr};
+
+	void signal() noexcept {
+		signal_.fetch_add(1, std::memory_order_release);
+		atomic_notify(signal_, 1);
+	}
+};
+
+/// @brief Wait state shared by the shards of a sharded_object_pool. A borrower parks here once every shard is
+/// exhausted, and a return to any shard wakes it.
+struct pool_group {
+	cache_padded<std::atomic<uint32_t>> waiters_{0};
+	std::atomic<uint32_t> wake_seq_{0};
+
+	void wake(uint32_t count) noexcept {
+		wake_seq_.fetch_add(1, std::memory_order_release);
+		atomic_notify(wake_seq_, count);
+	}
+};
+
+/// @brief Intrusive queue of waiters in arrival order, guarded by the owning pool.
+template <typename Node>
+class waiter_queue {
+private:
+	pool_waiter<Node>* head_;
+	pool_waiter<Node>* tail_;
+
+public:
+	waiter_queue() noexcept :
+		head_{nullptr},
+		tail_{nullptr}
+	{ }
+
+	[[nodiscard]] bool empty() const noexcept { return head_ == nullptr; }
+
+	void push_back(pool_waiter<Node>* w) noexcept {
+		w->prev_ = tail_;
+		w->next_ = nullptr;
+		if (tail_ != nullptr) {
+			tail_->next_ = w;
+		} else {
+			head_ = w;
+		}
+		tail_ = w;
+	}
+
+	[[nodiscard]] pool_waiter<Node>* pop_front() noexcept {
+		auto* w = head_;
+		remove(w);
+		return w;
+	}
+
+	void remove(pool_waiter<Node>* w) noexcept {
+		(w->prev_ != nullptr ? w->prev_->next_ : head_) = w->next_;
+		(w->next_ != nullptr ? w->next_->prev_ : tail_) = w->prev_;
+		w->prev_ = nullptr;
+		w->next_ = nullptr;
+	}
+};
+
+/// @brief A thread local stack of free nodes belonging to a single pool, only pools with the pool_mpmc policy have them.
+/// Only the owning thread touches the rounds, the owner is cleared by the pool on destruction.
+template <typename T>
+struct magazine {
+	std::atomic<object_pool<T>*> owner_;
+	std::unique_ptr<pool_node<T>*[]> rounds_;
+	std::size_t size_;
+	std::size_t capacity_;
+
+	explicit magazine(object_pool<T>* init_owner) :
+		owner_{init_owner},
+		rounds_{std::make_unique<pool_node<T>*[]>(init_owner->magazine_size())},
+		size_{0},
+		capacity_{init_owner->magazine_size()}
+	{ }
+
+	[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+	[[nodiscard]] bool full() const noexcept { return size_ == capacity_; }
+
+	void push(pool_node<T>* n) noexcept { rounds_[size_++] = n; }
+
+	[[nodiscard]] pool_node<T>* pop() noexcept { return rounds_[--size_]; }
 };
 
 } // end namespace details
@@ -81,19 +660,78 @@ public:
 /// @brief The object_pool class allows for the allocation of N number of T objects in a thread safe manner. 
 /// An object can be borrowed from the pool and will be returned to the pool upon destruction.
 /// @tparam T The type to allocate in the pool
-template <typename T>
+/// @tparam Concurrency pool_mpmc, pool_spsc or pool_single_thread. Only pool_mpmc pools have per-thread
+/// magazines and release idle chunks, the other policies ignore those options.
+template <typename T, typename Concurrency>
 class object_pool {
 public:
-	using node = details::pool_node<T>;
+	using node = details::pool_node<T, Concurrency>;
+	using block = typename node::block;
+
+	static constexpr bool is_mpmc = std::is_same_v<Concurrency, pool_mpmc>;
+	static constexpr bool is_spsc = std::is_same_v<Concurrency, pool_spsc>;
+	static constexpr bool is_single_thread = std::is_same_v<Concurrency, pool_single_thread>;
+	static constexpr bool padded = object_pool_padding_v<T>;
+
+	static_assert(is_mpmc || is_spsc || is_single_thread, "object_pool concurrency must be pool_mpmc, pool_spsc or pool_single_thread");
 
 private:
+	using magazine = details::magazine<T>;
+
+	using chunk = details::pool_chunk<node>;
+	using clock = std::chrono::steady_clock;
+
+	// Every deallocating thread considers trimming an elastic pool once per this many returns.
+	static constexpr uint32_t trim_interval = 1024;
+
+	// How long allocate and allocate_unique wait on an exhausted pool.
+	static constexpr std::chrono::milliseconds default_wait{50};
+
+	// Side table value of nodes without an object while the pool is destroyed, never a valid index.
+	static constexpr uint32_t unbuilt_mark = details::npos_index - 1;
+
+	// A pool_spsc returner checks for a waiter without a full fence, so a borrower re-checks this often.
+	static constexpr std::chrono::microseconds spsc_wait_slice{100};
+
 	std::pmr::polymorphic_allocator<std::byte> allocator_;
-	std::pmr::vector<std::unique_ptr<node>> nodes_;
-	std::atomic<node*> head_;
-	std::size_t capacity_;
-	std::atomic<uint32_t> waiters_;
-	std::mutex mutex_;
-	std::condition_variable ready_;
+	std::function<T()> generator_;
+	std::function<void(T&)> reset_;
+	pool_recycle recycle_;  // Checked on every return and borrow, a well predicted branch for as_is
+	node* slab_;  // The initial capacity in one contiguous allocation
+	bool owns_slab_;  // False if the slab lives in storage provided by a static_object_pool
+	std::atomic<uint32_t> fresh_;  // Slab nodes at and past this index were never touched, lazy pools only
+	std::atomic<uint64_t> unbuilt_;  // details::tagged_index, nodes without an object because their generator threw
+	// Freelist link of every node index up to the maximum capacity. Kept apart from the nodes so a popping
+	// thread that loses its race never reads from a chunk that a concurrent trim has just released.
+	details::link_table links_;
+	std::pmr::vector<chunk> chunks_;  // Node pointers are atomic, everything else is guarded by grow_mutex_
+	// A std::shared_ptr control block per node index up to the maximum capacity, set up by the first borrow
+	// through a std::shared_ptr so pools only ever used through pool_ptr don't pay for them.
+	std::atomic<std::byte*> control_blocks_;
+	bool owns_control_blocks_;  // False if the control blocks live in storage provided by a static_object_pool
+	// details::tagged_index, the borrower's private stack unless pool_mpmc. Every borrow and return writes it,
+	// so it gets a cache line of its own instead of invalidating the read-mostly fields around it, unless T opts
+	// out through object_pool_padding.
+	details::padded_if<std::atomic<uint64_t>, padded> head_;
+	// Returned nodes on their way back to the borrower, pool_spsc only.
+	std::conditional_t<is_spsc, details::spsc_ring, details::no_spsc_ring> returns_;
+	std::size_t initial_capacity_;
+	std::atomic<std::size_t> capacity_;
+	std::size_t max_capacity_;
+	std::size_t chunk_size_;
+	pool_growth growth_;
+	std::chrono::milliseconds idle_release_;
+	clock::time_point last_trim_;  // Guarded by grow_mutex_
+	std::size_t magazine_size_;
+	std::vector<magazine*> magazines_;  // Guarded by details::thread_cache_mutex()
+	details::padded_if<std::atomic<uint32_t>, padded> waiters_;  // Read by every return, kept apart from head_ and the fields above
+	std::atomic<uint32_t> wake_seq_;  // Bumped whenever parked borrowers are woken, they wait on this word
+	bool fifo_;  // Waiters queue in line and returned nodes are handed to them directly, pool_mpmc only
+	std::mutex line_mutex_;
+	details::waiter_queue<node> line_;  // Guarded by line_mutex_
+	details::pool_group* group_;  // The wait state of the sharded_object_pool this pool is a shard of, if any
+	std::mutex grow_mutex_;
+	std::conditional_t<GENESIS_OBJECT_POOL_STATS != 0, details::pool_counters<padded>, details::no_pool_counters> counters_;
 
 public:
 	/// @brief Construct a new object_pool object.
@@ -110,101 +748,1030 @@ public:
 		Generator gen,
 		std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()
 	) :
-		allocator_{mem_resource},
-		nodes_{allocator_},
-		capacity_{init_capacity},
-		head_{nullptr},
-		waiters_{0}
-	{
-		initial_allocation(gen);
-	}
+		object_pool{object_pool_options{init_capacity}, gen, mem_resource}
+	{ }
+
+	/// @brief Construct a new object_pool object from a set of options.
+	/// @tparam Generator Function that returns a object type T.
+	/// @param opts The options for the object_pool, see object_pool_options.
+	/// @param gen The generator function that must return an object of type T.
+	/// @param mem_resource The memory resource in which to do the allocations.
+	template <
+		typename Generator,
+		std::enable_if_t<std::is_invocable_r_v<T, Generator>, int> = 0
+	>
+	object_pool(
+		const object_pool_options& opts,
+		Generator gen,
+		std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()
+	) :
+		object_pool{opts, std::move(gen), details::default_reset<T>(), mem_resource}
+	{ }
+
+	/// @brief Construct a new object_pool object from a set of options with a reset hook for the recycle policy.
+	/// @tparam Generator Function that returns a object type T.
+	/// @tparam Reset Function that takes a T& and puts it back into a reusable state, it must not throw
+	/// when it runs on return.
+	/// @param opts The options for the object_pool, see object_pool_options.
+	/// @param gen The generator function that must return an object of type T.
+	/// @param reset The reset hook used by pool_recycle::reset_on_return and pool_recycle::reset_on_borrow.
+	/// @param mem_resource The memory resource in which to do the allocations.
+	template <
+		typename Generator,
+		typename Reset,
+		std::enable_if_t<std::is_invocable_r_v<T, Generator> && std::is_invocable_v<Reset, T&>, int> = 0
+	>
+	object_pool(
+		const object_pool_options& opts,
+		Generator gen,
+		Reset reset,
+		std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()
+	) :
+		object_pool{opts, std::function<T()>{std::move(gen)}, std::function<void(T&)>{std::move(reset)}, mem_resource, nullptr, nullptr, nullptr, nullptr}
+	{ }
+
+	/// @brief Construct a new object_pool object from a set of options with all objects being constructed
+	/// with the default constructor of type T.
+	/// @param opts The options for the object_pool, see object_pool_options.
+	/// @param mem_resource The memory resource in which to do the allocations.
+	explicit object_pool(const object_pool_options& opts, std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()) :
+		object_pool{opts, []() { return T{}; }, mem_resource}
+	{ }
 
 	/// @brief Construct a new object_pool object with all objects being constructed with the default constructor of type T.
 	/// @param init_capacity The initial capacity for the object_pool.
 	/// @param mem_resource The memory resource in which to do the allocations.
 	explicit object_pool(std::size_t init_capacity, std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()) :
+		object_pool{object_pool_options{init_capacity}, mem_resource}
+	{ }
+
+protected:
+	/// @brief Construct a new object_pool object, placing the slab and the freelist links in the given storage
+	/// instead of allocating them from the memory resource when they are not nullptr.
+	/// @param slab_storage Raw storage of node::block_size(opts.capacity) bytes aligned to node::block_alignment(),
+	/// it must outlive the pool.
+	/// @param link_storage Raw storage for the links of max(opts.capacity, opts.max_capacity) nodes.
+	/// @param ring_storage Raw storage for one more slot than that, only used by pool_spsc pools.
+	/// @param control_storage Raw storage for details::control_block_size bytes per node, aligned like std::max_align_t.
+	object_pool(
+		const object_pool_options& opts,
+		std::function<T()> gen,
+		std::function<void(T&)> reset,
+		std::pmr::memory_resource* mem_resource,
+		std::byte* slab_storage,
+		std::atomic<uint32_t>* link_storage,
+		std::atomic<uint32_t>* ring_storage,
+		std::byte* control_storage
+	) :
 		allocator_{mem_resource},
-		nodes_{allocator_},
-		capacity_{init_capacity},
-		head_{nullptr},
-		waiters_{0}
+		generator_{std::move(gen)},
+		reset_{std::move(reset)},
+		recycle_{checked_recycle(opts, reset_)},
+		slab_{slab_storage != nullptr ? place_block(slab_storage, 0) : nullptr},
+		owns_slab_{slab_storage == nullptr},
+		fresh_{0},
+		unbuilt_{details::tagged_index{details::npos_index, 0}.pack()},
+		links_{checked_max_capacity(opts), mem_resource, link_storage},
+		chunks_(chunk_count(opts), allocator_),
+		control_blocks_{control_storage},
+		owns_control_blocks_{control_storage == nullptr},
+		head_{details::tagged_index{details::npos_index, 0}.pack()},
+		returns_{is_spsc ? checked_max_capacity(opts) + 1 : 0, mem_resource, ring_storage},
+		initial_capacity_{opts.capacity},
+		capacity_{0},
+		max_capacity_{checked_max_capacity(opts)},
+		chunk_size_{chunk_size(opts)},
+		growth_{opts.growth},
+		idle_release_{is_mpmc ? opts.idle_release : std::chrono::milliseconds::max()},
+		last_trim_{},
+		magazine_size_{is_mpmc ? opts.magazine_size : 0},
+		magazines_{},
+		waiters_{0},
+		wake_seq_{0},
+		fifo_{is_mpmc && opts.fairness == pool_fairness::fifo},
+		line_mutex_{},
+		line_{},
+		group_{nullptr}
 	{
-		initial_allocation([]() { return T{}; });
+		initial_allocation(opts.construction);
 	}
 
+public:
 	~object_pool() {
-		for (auto& n : nodes_) {
-			n->destroy();
+		{
+			std::scoped_lock lock{details::thread_cache_mutex()};
+			for (auto* m : magazines_) {
+				m->size_ = 0;
+				m->owner_.store(nullptr, std::memory_order_release);
+			}
+		}
+		mark_unbuilt();
+		destroy_slab();
+		for (std::size_t k = 0; k < chunks_.size(); ++k) {
+			release_chunk(k);
+		}
+		if (auto* blocks = control_blocks_.load(std::memory_order_relaxed); owns_control_blocks_ && blocks != nullptr) {
+			allocator_.resource()->deallocate(blocks, max_capacity_ * details::control_block_size, alignof(std::max_align_t));
 		}
 	}
 
 	/// @brief Capacity observor for object_pool.
-	/// @return std::size_t the total capactiy of the pool.
-	[[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+	/// @return std::size_t the total capactiy of the pool, including any chunks it has grown by.
+	[[nodiscard]] std::size_t capacity() const noexcept { return capacity_.load(std::memory_order_relaxed); }
+
+	/// @brief Maximum capacity observor for object_pool.
+	/// @return std::size_t the capacity the pool may grow to.
+	[[nodiscard]] std::size_t max_capacity() const noexcept { return max_capacity_; }
+
+	/// @brief Magazine size observor for object_pool.
+	/// @return std::size_t the number of nodes each thread may cache, 0 if thread caching is disabled.
+	[[nodiscard]] std::size_t magazine_size() const noexcept { return magazine_size_; }
 
 	/// @brief Const node observor for the head node of the pool.
 	/// @return const node* the head of the node.
-	[[nodiscard]] const node* head() const noexcept { return head_.load(); }
+	[[nodiscard]] const node* head() const noexcept { return node_at(details::tagged_index::unpack(head_->load()).index); }
 
 	/// @brief Node observor for the head of the pool 
 	/// @return node* the head of the node.
-	[[nodiscard]] node* head() noexcept { return head_.load(); }
+	[[nodiscard]] node* head() noexcept { return node_at(details::tagged_index::unpack(head_->load()).index); }
 
-	/// @brief Allocates an object from the pool.
+	/// @brief Allocates an object from the pool, waiting up to 50ms for one to be returned if the pool is exhausted.
 	/// If a valid allocation will return a std::optional with a valid shared pointer of type T.
-	/// Otherwise will return a std::nullopt.
+	/// Otherwise will return a std::nullopt. The control block of the shared pointer lives inside the pool,
+	/// the object returns to the pool once the last std::shared_ptr and std::weak_ptr to it are gone.
+	/// The first call sets aside the storage for the control blocks of every object the pool may hold.
 	/// @return std::optional<std::shared_ptr<T>>
-	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate();
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate() { return allocate_for(default_wait); }
+
+	/// @brief Allocates an object from the pool, waiting until an object is returned or a stop is requested.
+	/// @param token Stop token that cancels the wait, waiters are woken as soon as stop is requested.
+	/// @return std::optional<std::shared_ptr<T>> std::nullopt if stop was requested before an object was returned.
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate(inplace_stop_token token) {
+		return make_shared(acquire_until(clock::time_point::max(), token));
+	}
+
+	/// @brief Allocates an object from the pool, waiting at most rel_time for one to be returned.
+	/// @param rel_time The longest time to wait for.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return std::optional<std::shared_ptr<T>> std::nullopt on timeout or stop.
+	template <typename Rep, typename Period>
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate_for(
+		const std::chrono::duration<Rep, Period>& rel_time,
+		inplace_stop_token token = {}
+	) {
+		return make_shared(acquire_until(deadline_after(rel_time), token));
+	}
+
+	/// @brief Allocates an object from the pool, waiting until abs_time at the latest for one to be returned.
+	/// @param abs_time The point in time to stop waiting at.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return std::optional<std::shared_ptr<T>> std::nullopt on timeout or stop.
+	template <typename Clock, typename Duration>
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate_until(
+		const std::chrono::time_point<Clock, Duration>& abs_time,
+		inplace_stop_token token = {}
+	) {
+		return make_shared(acquire_until(deadline_at(abs_time), token));
+	}
+
+	/// @brief Allocates an object from the pool, waiting up to 50ms for one to be returned if the pool is exhausted.
+	/// @return pool_ptr<T> the borrowed object, empty if none became available.
+	[[nodiscard]] pool_ptr<T, Concurrency> allocate_unique() { return allocate_unique_for(default_wait); }
+
+	/// @brief Allocates an object from the pool, waiting until an object is returned or a stop is requested.
+	/// @param token Stop token that cancels the wait, waiters are woken as soon as stop is requested.
+	/// @return pool_ptr<T> the borrowed object, empty if stop was requested before an object was returned.
+	[[nodiscard]] pool_ptr<T, Concurrency> allocate_unique(inplace_stop_token token) {
+		return pool_ptr<T, Concurrency>{acquire_until(clock::time_point::max(), token)};
+	}
+
+	/// @brief Allocates an object from the pool, waiting at most rel_time for one to be returned.
+	/// @param rel_time The longest time to wait for.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return pool_ptr<T> the borrowed object, empty on timeout or stop.
+	template <typename Rep, typename Period>
+	[[nodiscard]] pool_ptr<T, Concurrency> allocate_unique_for(const std::chrono::duration<Rep, Period>& rel_time, inplace_stop_token token = {}) {
+		return pool_ptr<T, Concurrency>{acquire_until(deadline_after(rel_time), token)};
+	}
+
+	/// @brief Allocates an object from the pool, waiting until abs_time at the latest for one to be returned.
+	/// @param abs_time The point in time to stop waiting at.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return pool_ptr<T> the borrowed object, empty on timeout or stop.
+	template <typename Clock, typename Duration>
+	[[nodiscard]] pool_ptr<T, Concurrency> allocate_unique_until(const std::chrono::time_point<Clock, Duration>& abs_time, inplace_stop_token token = {}) {
+		return pool_ptr<T, Concurrency>{acquire_until(deadline_at(abs_time), token)};
+	}
+
+	/// @brief Allocates an object from the pool without waiting.
+	/// @return pool_ptr<T> the borrowed object, empty if the pool is exhausted.
+	[[nodiscard]] pool_ptr<T, Concurrency> try_allocate();
+
+	/// @brief Borrows up to count objects without waiting, detaching them from the freelist as one chain.
+	/// Fewer objects are handed out if the pool runs dry and can't grow any further.
+	/// @param count The number of objects wanted.
+	/// @param out Output iterator that receives a pool_ptr<T> for every borrowed object.
+	/// @return std::size_t the number of objects borrowed.
+	template <typename OutputIt>
+	std::size_t allocate_n(std::size_t count, OutputIt out);
+
+	/// @brief Returns every borrowed object held by the range of pool_ptr<T> to the pool, leaving the handles empty.
+	/// The objects borrowed from this pool are spliced back onto the freelist as one chain.
+	/// @param range Range of pool_ptr<T>, handles borrowed from another pool are reset one by one.
+	template <typename Range>
+	void deallocate_n(Range&& range) noexcept;
 
 	/// @brief Deallocates a node and returns it back to the object_pool
 	/// @param n The node to be deleted from the pool
 	void deallocate(node* n) noexcept {
 		if (n == nullptr) { return; }
-		auto old_head = head_.load(std::memory_order_relaxed);
-		do {
-			n->next_ = old_head;
-		} while (!head_.compare_exchange_weak(old_head, n, std::memory_order_release, std::memory_order_relaxed));
-		if (waiters_ > 0) {
-			std::scoped_lock lock{mutex_};
-			ready_.notify_one();
+		counters_.returned(1);
+		if (recycle_ != pool_recycle::as_is && !recycle(n)) { return; }
+		if (fifo_ && waiters_->load(std::memory_order_seq_cst) > 0 && hand_off(n)) { return; }
+		// Blocked borrowers can't see thread cached nodes, so hand them straight back while anyone waits.
+		if constexpr (is_mpmc) {
+			if (magazine_size_ != 0 && !has_waiters()) {
+				if (auto* mag = local_magazine(); mag != nullptr) {
+					if (mag->full()) { spill(*mag, (mag->capacity_ + 1) / 2); }
+					mag->push(n);
+					return;
+				}
+			}
 		}
+		push_chain(n, n, 1);
+		if (!chunks_.empty() && idle_release_ != std::chrono::milliseconds::max()) { maybe_trim(); }
+	}
+
+	/// @brief Releases grown chunks that have been entirely unused for at least the idle period.
+	/// Runs from deallocate every so often, call it from a housekeeping thread for tighter control.
+	/// The freelist is briefly emptied while it is inspected, so concurrent borrowers may wait on it.
+	/// @return std::size_t the number of objects released.
+	std::size_t trim() noexcept {
+		if (chunks_.empty() || idle_release_ == std::chrono::milliseconds::max()) { return 0; }
+		std::scoped_lock lock{grow_mutex_};
+		return do_trim(clock::now());
+	}
+
+	/// @brief Takes a snapshot of the pool's counters for export to a metrics system.
+	/// @return object_pool_stats all counters but the capacity are zero unless GENESIS_OBJECT_POOL_STATS is 1.
+	[[nodiscard]] object_pool_stats stats() noexcept {
+		object_pool_stats snapshot{};
+		snapshot.capacity = capacity();
+		counters_.snapshot(snapshot);
+		return snapshot;
 	}
 
 	/// @brief The number of waiters.
 	/// @return uint32_T
-	[[nodiscard]] uint32_t waiters() const noexcept { return waiters_; }
+	[[nodiscard]] uint32_t waiters() const noexcept { return waiters_->load(); }
 
 private:
-	template <typename F>
-	void initial_allocation(F init) {
-		node* prev = nullptr;
-		for (std::size_t n = 0; n < capacity_; ++n) {
-			auto* raw_memory = allocator_.allocate(sizeof(object_pool::node));
-			auto node = genesis::construct_at(reinterpret_cast<object_pool::node*>(raw_memory), this, prev);
-			node->construct(init());
-			prev = node;
-			nodes_.emplace_back(node);
+	[[nodiscard]] static pool_recycle checked_recycle(const object_pool_options& opts, const std::function<void(T&)>& reset) {
+		bool needs_reset = opts.recycle == pool_recycle::reset_on_return || opts.recycle == pool_recycle::reset_on_borrow;
+		if (needs_reset && !reset) {
+			throw std::invalid_argument{"object_pool reset policy needs a reset hook or a T::reset() member"};
+		}
+		return opts.recycle;
+	}
+
+	/// @brief Applies the recycle policy to a node that is being returned.
+	/// @return bool false if reconstructing failed and the node was parked without an object.
+	bool recycle(node* n) noexcept {
+		if (recycle_ == pool_recycle::reset_on_return) {
+			reset_(**n);
+		} else if (recycle_ == pool_recycle::reconstruct) {
+			n->destroy();
+			try {
+				n->construct(generator_());
+			} catch (...) {
+				// Parked like a lazy node whose generator threw, the next borrow that runs dry retries it.
+				push_unbuilt(n->index());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// @brief Applies the recycle policy to a node that is about to be handed out.
+	node* prepare(node* n) {
+		if (recycle_ == pool_recycle::reset_on_borrow && n != nullptr) {
+			try {
+				reset_(**n);
+			} catch (...) {
+				if constexpr (is_spsc) {
+					// The borrowing thread never pushes onto the returns ring, the node goes back on its own stack.
+					counters_.returned(1);
+					push_owned(n, n, 1);
+				} else {
+					deallocate(n);
+				}
+				throw;
+			}
+		}
+		return n;
+	}
+
+	[[nodiscard]] static std::size_t checked_max_capacity(const object_pool_options& opts) {
+		auto max_capacity = std::max(opts.max_capacity, opts.capacity);
+		if (max_capacity >= details::npos_index) {
+			throw std::length_error{"object_pool capacity exceeds the 32-bit node index space"};
+		}
+		return max_capacity;
+	}
+
+	[[nodiscard]] static std::size_t chunk_size(const object_pool_options& opts) noexcept {
+		return opts.chunk_size != 0 ? opts.chunk_size : (opts.capacity != 0 ? opts.capacity : 64);
+	}
+
+	[[nodiscard]] static std::size_t chunk_count(const object_pool_options& opts) {
+		return (checked_max_capacity(opts) - opts.capacity + chunk_size(opts) - 1) / chunk_size(opts);
+	}
+
+	void initial_allocation(pool_construction construction) {
+		if (initial_capacity_ == 0) { return; }
+		capacity_.store(initial_capacity_, std::memory_order_relaxed);
+		if (construction == pool_construction::lazy) {
+			if (owns_slab_) { slab_ = allocate_nodes(0, initial_capacity_); }
+			return;
+		}
+		if (owns_slab_) {
+			slab_ = build_nodes(0, initial_capacity_);
+		} else {
+			construct_nodes(slab_, 0, initial_capacity_);
+		}
+		fresh_.store(static_cast<uint32_t>(initial_capacity_), std::memory_order_relaxed);
+		head_->store(details::tagged_index{0, 0}.pack(), std::memory_order_relaxed);
+	}
+
+	/// @brief Marks the nodes on the unbuilt stack in the side table, nothing is linked through it any more
+	/// once the pool is being destroyed.
+	void mark_unbuilt() noexcept {
+		for (auto i = details::tagged_index::unpack(unbuilt_.load()).index; i != details::npos_index;) {
+			i = links_[i].exchange(unbuilt_mark, std::memory_order_relaxed);
+		}
+	}
+
+	/// @brief Destroys the slab, skipping the nodes that never got an object.
+	void destroy_slab() noexcept {
+		auto touched = std::min<std::size_t>(fresh_.load(std::memory_order_relaxed), initial_capacity_);
+		for (std::size_t i = 0; i < touched; ++i) {
+			if (links_[i].load(std::memory_order_relaxed) != unbuilt_mark) { slab_[i].destroy(); }
+		}
+		if (owns_slab_ && slab_ != nullptr) { deallocate_nodes(slab_, initial_capacity_); }
+	}
+
+	/// @brief Constructs the object of a node that has none, either a slab node of a lazy pool that was never
+	/// borrowed or a node whose generator threw before.
+	/// @return node* the node, nullptr if there is no such node.
+	node* take_fresh() {
+		auto index = pop_unbuilt();
+		if (index == details::npos_index) {
+			if (fresh_.load(std::memory_order_relaxed) >= initial_capacity_) { return nullptr; }
+			index = fresh_.fetch_add(1, std::memory_order_relaxed);
+			if (index >= initial_capacity_) { return nullptr; }
+			genesis::construct_at(slab_ + index, index);
+		}
+		auto* n = node_at(index);
+		try {
+			n->construct(generator_());
+		} catch (...) {
+			push_unbuilt(index);
+			throw;
+		}
+		return n;
+	}
+
+	[[nodiscard]] uint32_t pop_unbuilt() noexcept {
+		auto old_head = unbuilt_.load(std::memory_order_acquire);
+		while (true) {
+			auto head = details::tagged_index::unpack(old_head);
+			if (head.index == details::npos_index) { return head.index; }
+			auto next = links_[head.index].load(std::memory_order_relaxed);
+			if (unbuilt_.compare_exchange_weak(old_head, head.next(next), std::memory_order_acquire, std::memory_order_acquire)) {
+				return head.index;
+			}
+		}
+	}
+
+	void push_unbuilt(uint32_t index) noexcept {
+		auto old_head = unbuilt_.load(std::memory_order_relaxed);
+		details::tagged_index head{};
+		do {
+			head = details::tagged_index::unpack(old_head);
+			links_[index].store(head.index, std::memory_order_relaxed);
+		} while (!unbuilt_.compare_exchange_weak(old_head, head.next(index), std::memory_order_seq_cst, std::memory_order_relaxed));
+		// A parked borrower may be the one to retry the generator.
+		if (waiters_->load(std::memory_order_seq_cst) > 0) { wake(1); }
+		if (group_ != nullptr && group_->waiters_->load(std::memory_order_seq_cst) > 0) { group_->wake(1); }
+	}
+
+	/// @brief Allocates count contiguous nodes starting at index first, constructs their objects with the
+	/// generator, and links them in address order so they are handed out front to back.
+	node* build_nodes(uint32_t first, std::size_t count) {
+		auto* nodes = allocate_nodes(first, count);
+		try {
+			construct_nodes(nodes, first, count);
+		} catch (...) {
+			deallocate_nodes(nodes, count);
+			throw;
+		}
+		return nodes;
+	}
+
+	/// @brief Constructs count nodes and their objects in raw storage, destroying them again if the generator throws.
+	void construct_nodes(node* nodes, uint32_t first, std::size_t count) {
+		std::size_t constructed = 0;
+		try {
+			for (; constructed < count; ++constructed) {
+				auto index = static_cast<uint32_t>(first + constructed);
+				genesis::construct_at(nodes + constructed, static_cast<uint32_t>(constructed))->construct(generator_());
+				links_[index].store(constructed + 1 < count ? index + 1 : details::npos_index, std::memory_order_relaxed);
+			}
+		} catch (...) {
+			destroy_objects(nodes, constructed);
+			throw;
+		}
+	}
+
+	/// @brief Destroys the objects of the first count nodes, skipping the nodes that have none.
+	void destroy_objects(node* nodes, std::size_t count) noexcept {
+		for (std::size_t n = 0; n < count; ++n) {
+			if (links_[nodes[n].index()].load(std::memory_order_relaxed) != unbuilt_mark) { nodes[n].destroy(); }
+		}
+	}
+
+	/// @brief Destroys the objects of count nodes and hands the nodes back to the memory resource.
+	void destroy_nodes(node* nodes, std::size_t count) noexcept {
+		if (nodes == nullptr) { return; }
+		destroy_objects(nodes, count);
+		deallocate_nodes(nodes, count);
+	}
+
+	/// @brief Allocates a block for count nodes, the first of which gets index first.
+	[[nodiscard]] node* allocate_nodes(uint32_t first, std::size_t count) {
+		return place_block(static_cast<std::byte*>(allocator_.resource()->allocate(node::block_size(count), node::block_alignment())), first);
+	}
+
+	void deallocate_nodes(node* nodes, std::size_t count) noexcept {
+		auto* storage = reinterpret_cast<std::byte*>(nodes) - node::block_header_size();
+		allocator_.resource()->deallocate(storage, node::block_size(count), node::block_alignment());
+	}
+
+	/// @brief Writes the block header into raw storage.
+	/// @return node* where the first node of the block goes.
+	node* place_block(std::byte* storage, uint32_t first) noexcept {
+		genesis::construct_at(reinterpret_cast<block*>(storage), block{this, first});
+		return reinterpret_cast<node*>(storage + node::block_header_size());
+	}
+
+	[[nodiscard]] uint32_t chunk_first(std::size_t k) const noexcept {
+		return static_cast<uint32_t>(initial_capacity_ + k * chunk_size_);
+	}
+
+	[[nodiscard]] std::size_t chunk_nodes(std::size_t k) const noexcept {
+		return std::min(chunk_size_, max_capacity_ - chunk_first(k));
+	}
+
+	[[nodiscard]] std::size_t chunk_of(uint32_t index) const noexcept {
+		return (index - initial_capacity_) / chunk_size_;
+	}
+
+	[[nodiscard]] node* node_at(uint32_t index) const noexcept {
+		if (index < initial_capacity_) { return slab_ + index; }
+		if (index == details::npos_index) { return nullptr; }
+		auto offset = index - initial_capacity_;
+		return chunks_[offset / chunk_size_].nodes_.load(std::memory_order_relaxed) + offset % chunk_size_;
+	}
+
+	/// @brief Adds chunks according to the growth policy.
+	/// @return bool false once the pool is at its maximum capacity.
+	bool grow() {
+		if (chunks_.empty() || capacity() == max_capacity_) { return false; }
+		// Only pool_mpmc pools can have more than one thread growing them.
+		std::unique_lock lock{grow_mutex_, std::defer_lock};
+		if constexpr (is_mpmc) { lock.lock(); }
+		// Another thread may have grown the pool, or returned objects, while this one waited on the lock.
+		if (details::tagged_index::unpack(head_->load(std::memory_order_acquire)).index != details::npos_index) {
+			return true;
+		}
+		std::size_t wanted = 1;
+		if (growth_ == pool_growth::geometric) {
+			wanted = std::max<std::size_t>((capacity() + chunk_size_ - 1) / chunk_size_, 1);
+		}
+		std::size_t added = 0;
+		for (std::size_t k = 0; k < chunks_.size() && added < wanted; ++k) {
+			if (chunks_[k].nodes_.load(std::memory_order_relaxed) != nullptr) { continue; }
+			auto count = chunk_nodes(k);
+			auto* nodes = build_nodes(chunk_first(k), count);
+			chunks_[k].nodes_.store(nodes, std::memory_order_release);
+			chunks_[k].idle_since_ = {};
+			capacity_.fetch_add(count, std::memory_order_relaxed);
+			push_owned(nodes, nodes + count - 1, count);
+			++added;
+		}
+		return added != 0;
+	}
+
+	void release_chunk(std::size_t k) noexcept {
+		auto* nodes = chunks_[k].nodes_.exchange(nullptr, std::memory_order_relaxed);
+		if (nodes == nullptr) { return; }
+		auto count = chunk_nodes(k);
+		destroy_nodes(nodes, count);
+		capacity_.fetch_sub(count, std::memory_order_relaxed);
+	}
+
+	void maybe_trim() noexcept {
+		static thread_local uint32_t countdown{trim_interval};
+		if (--countdown != 0) { return; }
+		countdown = trim_interval;
+		std::unique_lock lock{grow_mutex_, std::try_to_lock};
+		if (!lock.owns_lock()) { return; }
+		auto now = clock::now();
+		if (now - last_trim_ >= idle_release_ / 4) { do_trim(now); }
+	}
+
+	/// @brief Releases the chunks that have been idle long enough, the caller must hold grow_mutex_.
+	std::size_t do_trim(clock::time_point now) noexcept {
+		last_trim_ = now;
+		// Take the whole freelist so nothing can be popped from a chunk while it is inspected.
+		auto old_head = head_->load(std::memory_order_acquire);
+		details::tagged_index head{};
+		do {
+			head = details::tagged_index::unpack(old_head);
+		} while (!head_->compare_exchange_weak(old_head, head.next(details::npos_index), std::memory_order_acquire, std::memory_order_relaxed));
+
+		for (auto& c : chunks_) { c.free_ = 0; }
+		for (auto i = head.index; i != details::npos_index; i = links_[i].load(std::memory_order_relaxed)) {
+			if (i >= initial_capacity_) { ++chunks_[chunk_of(i)].free_; }
+		}
+		for (std::size_t k = 0; k < chunks_.size(); ++k) {
+			auto& c = chunks_[k];
+			if (c.nodes_.load(std::memory_order_relaxed) == nullptr || c.free_ != chunk_nodes(k)) {
+				c.free_ = 0;
+				c.idle_since_ = {};
+				continue;
+			}
+			if (c.idle_since_ == clock::time_point{}) { c.idle_since_ = now; }
+			// From here on a non-zero count marks the chunk for release, anything not idle long enough stays.
+			if (now - c.idle_since_ < idle_release_) { c.free_ = 0; }
+		}
+
+		// Put back everything that is not about to be released.
+		node* first = nullptr;
+		node* last = nullptr;
+		uint32_t kept = 0;
+		for (auto i = head.index; i != details::npos_index;) {
+			auto next = links_[i].load(std::memory_order_relaxed);
+			if (i < initial_capacity_ || chunks_[chunk_of(i)].free_ == 0) {
+				auto* n = node_at(i);
+				if (last == nullptr) {
+					first = n;
+				} else {
+					links_[last->index()].store(i, std::memory_order_relaxed);
+				}
+				last = n;
+				++kept;
+			}
+			i = next;
+		}
+		if (first != nullptr) { push_chain(first, last, kept); }
+
+		std::size_t released = 0;
+		for (std::size_t k = 0; k < chunks_.size(); ++k) {
+			if (chunks_[k].free_ != 0) {
+				released += chunk_nodes(k);
+				chunks_[k].idle_since_ = {};
+				release_chunk(k);
+			}
+		}
+		return released;
+	}
+
+	magazine* local_magazine() noexcept {
+		if constexpr (is_mpmc) {
+			try {
+				return details::thread_cache_depot<object_pool<T>, magazine>::local(this);
+			} catch (...) {
+				// Failing to create a magazine only costs the fast path.
+				return nullptr;
+			}
+		} else {
+			return nullptr;
+		}
+	}
+
+	node* acquire() {
+		auto* n = prepare(take());
+		if (n != nullptr) { counters_.borrowed(1); }
+		return n;
+	}
+
+	node* take() {
+		if constexpr (is_mpmc) {
+			if (magazine_size_ != 0) {
+				if (auto* mag = local_magazine(); mag != nullptr) {
+					if (mag->empty()) { refill(*mag, (mag->capacity_ + 1) / 2); }
+					return mag->empty() ? nullptr : mag->pop();
+				}
+			}
+		}
+		return pop_or_grow();
+	}
+
+	node* pop_or_grow() {
+		while (true) {
+			if (auto* n = do_allocate(); n != nullptr) { return n; }
+			if (auto* n = take_fresh(); n != nullptr) { return n; }
+			if (!grow()) { return nullptr; }
+		}
+	}
+
+	/// @brief Takes up to count nodes off the freelist into the magazine with one CAS, growing the pool if allowed.
+	void refill(magazine& mag, std::size_t count, bool may_grow = true) {
+		std::size_t popped = 0;
+		auto* n = pop_chain(count, popped);
+		if (n == nullptr) {
+			if (auto* f = take_fresh(); f != nullptr) {
+				mag.push(f);
+				return;
+			}
+		}
+		while (n == nullptr && may_grow && grow()) {
+			n = pop_chain(count, popped);
+		}
+		for (; n != nullptr; n = node_at(links_[n->index()].load(std::memory_order_relaxed))) {
+			mag.push(n);
+		}
+	}
+
+	/// @brief Borrows a node on behalf of a sibling shard of a sharded_object_pool through the calling thread's
+	/// magazine, refilling it with a whole batch at once. Never grows this pool.
+	/// @return node* nullptr if nothing is left or the calling thread has no magazine for this pool.
+	node* steal() {
+		auto* mag = magazine_size_ != 0 ? local_magazine() : nullptr;
+		if (mag == nullptr) { return nullptr; }
+		if (mag->empty()) { refill(*mag, (mag->capacity_ + 1) / 2, false); }
+		return mag->empty() ? nullptr : lend(mag->pop());
+	}
+
+	/// @brief Takes up to count free nodes off the freelist with a single CAS on behalf of a sibling shard of a
+	/// sharded_object_pool, never grows this pool. The nodes count as free until lend hands them out.
+	/// @return std::size_t the number of nodes written to out.
+	std::size_t steal_n(std::size_t count, node** out) {
+		std::size_t popped = 0;
+		auto* n = pop_chain(count, popped);
+		if (n == nullptr) {
+			auto* f = take_fresh();
+			if (f == nullptr) { return 0; }
+			out[0] = f;
+			return 1;
+		}
+		for (auto** o = out; n != nullptr; ++o) {
+			*o = n;
+			n = node_at(links_[n->index()].load(std::memory_order_relaxed));
+		}
+		return popped;
+	}
+
+	/// @brief Puts back count nodes taken by steal_n that were never handed out.
+	void unsteal_n(node* const* nodes, std::size_t count) noexcept {
+		if (count == 0) { return; }
+		for (std::size_t i = 0; i + 1 < count; ++i) {
+			links_[nodes[i]->index()].store(nodes[i + 1]->index(), std::memory_order_relaxed);
+		}
+		push_chain(nodes[0], nodes[count - 1], static_cast<uint32_t>(count));
+	}
+
+	/// @brief Hands out a node taken by steal_n, applying the recycle policy and counting the borrow.
+	node* lend(node* n) {
+		n = prepare(n);
+		counters_.borrowed(1);
+		return n;
+	}
+
+	void spill(magazine& mag, std::size_t count) noexcept {
+		if (count == 0 || mag.empty()) { return; }
+		auto* last = mag.pop();
+		auto* first = last;
+		uint32_t spilled = 1;
+		while (spilled < count && !mag.empty()) {
+			auto* n = mag.pop();
+			links_[n->index()].store(first->index(), std::memory_order_relaxed);
+			first = n;
+			++spilled;
+		}
+		push_chain(first, last, spilled);
+	}
+
+	/// @brief Pushes the already linked chain [first, last] of count returned nodes onto the freelist with
+	/// a single CAS, then wakes one parked borrower per node. A pool_spsc pool passes them through the
+	/// returns ring instead, a pool_single_thread pool just links them onto its stack.
+	void push_chain(node* first, node* last, uint32_t count) noexcept {
+		if constexpr (is_single_thread) {
+			push_owned(first, last, count);
+			return;
+		} else if constexpr (is_spsc) {
+			for (auto i = first->index();;) {
+				// Read the link first, the borrower may take the node and relink it as soon as it is pushed.
+				auto next = links_[i].load(std::memory_order_relaxed);
+				returns_.push(i);
+				if (i == last->index()) { break; }
+				i = next;
+			}
+			if (waiters_->load(std::memory_order_relaxed) > 0) { wake(1); }
+			return;
+		}
+		auto old_head = head_->load(std::memory_order_relaxed);
+		while (true) {
+			auto head = details::tagged_index::unpack(old_head);
+			links_[last->index()].store(head.index, std::memory_order_relaxed);
+			if (head_->compare_exchange_weak(old_head, head.next(first->index()), std::memory_order_seq_cst, std::memory_order_relaxed)) { break; }
+			counters_.cas_retry();
+		}
+		// Pairs with the fence in acquire_until, either this sees the waiter or the waiter sees the nodes.
+		if (waiters_->load(std::memory_order_seq_cst) > 0) {
+			if (fifo_) {
+				hand_published();
+			} else {
+				wake(count);
+			}
+		}
+		if (group_ != nullptr && group_->waiters_->load(std::memory_order_seq_cst) > 0) { group_->wake(count); }
+	}
+
+	/// @brief Whether a borrower is parked on this pool, or on the sharded_object_pool it is a shard of.
+	[[nodiscard]] bool has_waiters() const noexcept {
+		return waiters_->load(std::memory_order_relaxed) > 0 || (group_ != nullptr && group_->waiters_->load(std::memory_order_relaxed) > 0);
+	}
+
+	/// @brief Gives a returned node straight to the oldest waiter of a fifo pool.
+	/// @return bool false if nobody is waiting in line any more.
+	bool hand_off(node* n) noexcept {
+		std::scoped_lock lock{line_mutex_};
+		if (line_.empty()) { return false; }
+		give(line_.pop_front(), n);
+		return true;
+	}
+
+	/// @brief Moves nodes from the freelist to the waiters of a fifo pool, oldest first. Catches the nodes that
+	/// were published while a borrower was getting in line.
+	void hand_published() noexcept {
+		std::scoped_lock lock{line_mutex_};
+		while (!line_.empty()) {
+			auto* n = do_allocate();
+			if (n == nullptr) { return; }
+			give(line_.pop_front(), n);
+		}
+	}
+
+	/// @brief Hands a node to a waiter that was just taken out of line, the caller must hold line_mutex_.
+	/// The waiter leaves through line_mutex_ as well, so it is still there when it is signalled.
+	static void give(details::pool_waiter<node>* w, node* n) noexcept {
+		w->handed_.store(n, std::memory_order_release);
+		w->signal();
+	}
+
+	/// @brief Pushes the already linked chain [first, last] of count nodes held by the borrowing side, which
+	/// is the freelist for pool_mpmc and the borrower's private stack for the other policies.
+	void push_owned(node* first, node* last, uint32_t count) noexcept {
+		if constexpr (is_mpmc) {
+			push_chain(first, last, count);
+		} else {
+			auto head = details::tagged_index::unpack(head_->load(std::memory_order_relaxed));
+			links_[last->index()].store(head.index, std::memory_order_relaxed);
+			head_->store(head.next(first->index()), std::memory_order_relaxed);
+		}
+	}
+
+	/// @brief Pushes a detached chain that ends at npos back onto the freelist.
+	void push_list(node* first) noexcept {
+		if (first == nullptr) { return; }
+		auto* last = first;
+		uint32_t count = 1;
+		for (auto i = links_[last->index()].load(std::memory_order_relaxed); i != details::npos_index; i = links_[i].load(std::memory_order_relaxed)) {
+			last = node_at(i);
+			++count;
+		}
+		push_owned(first, last, count);
+	}
+
+	void wake(uint32_t count) noexcept {
+		wake_seq_.fetch_add(1, std::memory_order_release);
+		details::atomic_notify(wake_seq_, count);
+	}
+
+	/// @brief Wakes every parked borrower so it can notice that its stop token was triggered.
+	struct stop_waker {
+		object_pool* pool_;
+
+		void operator()() const noexcept { pool_->wake(UINT32_MAX); }
+	};
+
+	template <typename Rep, typename Period>
+	[[nodiscard]] static clock::time_point deadline_after(const std::chrono::duration<Rep, Period>& rel_time) {
+		auto now = clock::now();
+		if (rel_time >= std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(clock::time_point::max() - now)) {
+			return clock::time_point::max();
+		}
+		return now + std::chrono::ceil<clock::duration>(rel_time);
+	}
+
+	template <typename Clock, typename Duration>
+	[[nodiscard]] static clock::time_point deadline_at(const std::chrono::time_point<Clock, Duration>& abs_time) {
+		if constexpr (std::is_same_v<Clock, clock>) {
+			return std::chrono::time_point_cast<clock::duration>(abs_time);
+		} else {
+			return deadline_after(abs_time - Clock::now());
+		}
+	}
+
+	void attach_cache(magazine& mag) {
+		std::scoped_lock lock{details::thread_cache_mutex()};
+		magazines_.push_back(&mag);
+	}
+
+	/// @brief Returns every node cached in the magazine, the caller must hold details::thread_cache_mutex().
+	void detach_cache(magazine& mag) noexcept {
+		spill(mag, mag.size_);
+		mag.owner_.store(nullptr, std::memory_order_release);
+		magazines_.erase(std::remove(magazines_.begin(), magazines_.end(), &mag), magazines_.end());
+	}
+
+	friend class details::thread_cache_depot<object_pool<T>, magazine>;
+	template <typename, typename>
+	friend struct details::control_block_allocator;
+	friend class sharded_object_pool<T>;
+
+	/// @brief Borrows a node, waiting while the pool is exhausted until the deadline or a stop request.
+	node* acquire_until(clock::time_point deadline, inplace_stop_token token) {
+		auto* n = wait_for_node(deadline, token);
+		if (n == nullptr) { counters_.failed(); }
+		return n;
+	}
+
+	/// @brief Borrows a node, parking on wake_seq_ while the pool is exhausted until the deadline or a stop request.
+	node* wait_for_node(clock::time_point deadline, inplace_stop_token token) {
+		if (auto* n = acquire(); n != nullptr) { return n; }
+		// Nothing can come back to a single threaded pool while its only thread waits.
+		if (is_single_thread || token.stop_requested()) { return nullptr; }
+		if (fifo_) { return wait_in_line(deadline, token); }
+		[[maybe_unused]] auto wait_start = GENESIS_OBJECT_POOL_STATS != 0 ? clock::now() : clock::time_point{};
+		inplace_stop_callback<stop_waker> on_stop{token, stop_waker{this}};
+		if constexpr (is_mpmc) {
+			waiters_->fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		} else {
+			waiters_->store(1, std::memory_order_relaxed);
+		}
+		node* n = nullptr;
+		while (true) {
+			auto seq = wake_seq_.load(std::memory_order_acquire);
+			n = acquire();
+			if (n != nullptr || token.stop_requested() || clock::now() >= deadline) { break; }
+			auto until = deadline;
+			if constexpr (is_spsc) { until = std::min(deadline, clock::now() + spsc_wait_slice); }
+			details::atomic_wait_until(wake_seq_, seq, until);
+		}
+		if constexpr (is_mpmc) {
+			waiters_->fetch_sub(1, std::memory_order_relaxed);
+		} else {
+			waiters_->store(0, std::memory_order_relaxed);
+		}
+		if constexpr (GENESIS_OBJECT_POOL_STATS != 0) { counters_.waited(clock::now() - wait_start); }
+		return n;
+	}
+
+	/// @brief Wakes a waiter of a fifo pool so it can notice that its stop token was triggered.
+	struct line_stop_waker {
+		details::pool_waiter<node>* waiter_;
+
+		void operator()() const noexcept { waiter_->signal(); }
+	};
+
+	/// @brief Queues behind the borrowers already waiting on a fifo pool and parks until a returning thread
+	/// hands over a node, the deadline passes or stop is requested.
+	node* wait_in_line(clock::time_point deadline, inplace_stop_token token) {
+		[[maybe_unused]] auto wait_start = GENESIS_OBJECT_POOL_STATS != 0 ? clock::now() : clock::time_point{};
+		details::pool_waiter<node> self{};
+		{
+			std::scoped_lock lock{line_mutex_};
+			line_.push_back(&self);
+			waiters_->fetch_add(1, std::memory_order_seq_cst);
+		}
+		// Pairs with the check in push_chain, nodes published before the waiter counted are handed out here.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		hand_published();
+		{
+			inplace_stop_callback<line_stop_waker> on_stop{token, line_stop_waker{&self}};
+			while (true) {
+				auto seq = self.signal_.load(std::memory_order_acquire);
+				if (self.handed_.load(std::memory_order_acquire) != nullptr) { break; }
+				if (token.stop_requested() || clock::now() >= deadline) { break; }
+				details::atomic_wait_until(self.signal_, seq, deadline);
+			}
+		}
+		node* n = nullptr;
+		{
+			std::scoped_lock lock{line_mutex_};
+			// A node handed over after the deadline is still taken, the waiter is no longer in line then.
+			n = self.handed_.load(std::memory_order_acquire);
+			if (n == nullptr) { line_.remove(&self); }
+			waiters_->fetch_sub(1, std::memory_order_relaxed);
+		}
+		if constexpr (GENESIS_OBJECT_POOL_STATS != 0) { counters_.waited(clock::now() - wait_start); }
+		if (n == nullptr) { return nullptr; }
+		n = prepare(n);
+		counters_.borrowed(1);
+		return n;
+	}
+
+	/// @brief The storage for the std::shared_ptr control block of the node at index.
+	[[nodiscard]] std::byte* control_block(uint32_t index) noexcept {
+		return control_blocks_.load(std::memory_order_acquire) + std::size_t{index} * details::control_block_size;
+	}
+
+	/// @brief Sets aside the storage for the control blocks, once for the life of the pool.
+	void reserve_control_blocks() {
+		if (control_blocks_.load(std::memory_order_acquire) != nullptr) { return; }
+		std::scoped_lock lock{grow_mutex_};
+		if (control_blocks_.load(std::memory_order_relaxed) != nullptr) { return; }
+		auto bytes = max_capacity_ * details::control_block_size;
+		control_blocks_.store(static_cast<std::byte*>(allocator_.resource()->allocate(bytes, alignof(std::max_align_t))), std::memory_order_release);
+	}
+
+	[[nodiscard]] static std::optional<std::shared_ptr<T>> make_shared(node* n) {
+		if (n == nullptr) { return std::nullopt; }
+		try {
+			n->home()->reserve_control_blocks();
+		} catch (...) {
+			n->home()->deallocate(n);
+			throw;
+		}
+		using allocator = details::control_block_allocator<T, node>;
+		return std::make_optional(std::shared_ptr<T>{n->data(), details::keep_alive_deleter{}, allocator{n}});
+	}
+
+	/// @brief Detaches up to count nodes from the front of the freelist with a single successful CAS.
+	/// The chain is walked before the CAS, the tagged head guarantees it was not touched if the CAS succeeds.
+	/// @return node* the first detached node, its chain ends at npos, or nullptr if the freelist is empty.
+	node* pop_chain(std::size_t count, std::size_t& popped) {
+		spin_wait spin{};
+		auto old_head = head_->load(std::memory_order_acquire);
+		while (true) {
+			auto head = details::tagged_index::unpack(old_head);
+			if (head.index == details::npos_index) {
+				popped = 0;
+				return nullptr;
+			}
+			auto last = head.index;
+			std::size_t taken = 1;
+			auto next = links_[last].load(std::memory_order_relaxed);
+			for (; taken < count && next != details::npos_index; ++taken) {
+				last = next;
+				next = links_[last].load(std::memory_order_relaxed);
+			}
+			if (head_->compare_exchange_weak(old_head, head.next(next), std::memory_order_acquire, std::memory_order_acquire)) {
+				links_[last].store(details::npos_index, std::memory_order_relaxed);
+				popped = taken;
+				return node_at(head.index);
+			}
+			counters_.cas_retry();
+			spin.wait();
 		}
-		head_ = prev;
 	}
 
 	node* do_allocate() {
-		node* p = nullptr;
+		if constexpr (!is_mpmc) {
+			auto head = details::tagged_index::unpack(head_->load(std::memory_order_relaxed));
+			if (head.index != details::npos_index) {
+				head_->store(head.next(links_[head.index].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+				return node_at(head.index);
+			}
+			if constexpr (is_spsc) { return node_at(returns_.pop()); }
+			return nullptr;
+		}
+		spin_wait spin{};
+		auto old_head = head_->load(std::memory_order_acquire);
 		while (true) {
-			p = head_.load(std::memory_order_acquire);
-			if (p == nullptr) return nullptr;
-			if (head_.compare_exchange_weak(p, p->next_, std::memory_order_release, std::memory_order_relaxed)) break;
-			std::this_thread::yield();
+			auto head = details::tagged_index::unpack(old_head);
+			if (head.index == details::npos_index) { return nullptr; }
+			// The node itself is only touched once the compare-exchange has made it ours.
+			auto next = links_[head.index].load(std::memory_order_relaxed);
+			if (head_->compare_exchange_weak(old_head, head.next(next), std::memory_order_acquire, std::memory_order_acquire)) {
+				return node_at(head.index);
+			}
+			counters_.cas_retry();
+			spin.wait();
 		}
-		return p;
 	}
 };
 
 /// @brief Deleter functor that returns items to the pool on destruction.
 /// @tparam T The type T.
-template <typename T>
+/// @tparam Concurrency The concurrency policy of the pool.
+template <typename T, typename Concurrency = pool_mpmc>
 struct pool_deleter {
-	using node_type = typename object_pool<T>::node;
+	using node_type = typename object_pool<T, Concurrency>::node;
 
 	node_type* node_;
 	
@@ -215,26 +1782,180 @@ struct pool_deleter {
 	}
 };
 
-/// @brief Allocates an object from the pool and returns a std::optional.
+/// @brief Move only handle to an object borrowed from an object_pool, returning it to its home pool on destruction.
+/// Unlike the std::shared_ptr returned by object_pool::allocate it is a single pointer wide and never allocates.
+/// @tparam T The type T borrowed from the pool.
+/// @tparam Concurrency The concurrency policy of the pool.
+template <typename T, typename Concurrency>
+class pool_ptr {
+public:
+	using element_type = T;
+	using pointer = T*;
+	using node_type = typename object_pool<T, Concurrency>::node;
+
+private:
+	node_type* node_;
+
+	explicit pool_ptr(node_type* init_node) noexcept :
+		node_{init_node}
+	{ }
+
+	friend class object_pool<T, Concurrency>;
+	friend class sharded_object_pool<T>;
+
+public:
+	constexpr pool_ptr() noexcept :
+		node_{nullptr}
+	{ }
+
+	constexpr pool_ptr(std::nullptr_t) noexcept :
+		node_{nullptr}
+	{ }
+
+	pool_ptr(const pool_ptr&) = delete;
+
+	pool_ptr(pool_ptr&& other) noexcept :
+		node_{std::exchange(other.node_, nullptr)}
+	{ }
+
+	pool_ptr& operator=(const pool_ptr&) = delete;
+
+	pool_ptr& operator=(pool_ptr&& other) noexcept {
+		if (this != &other) {
+			reset();
+			node_ = std::exchange(other.node_, nullptr);
+		}
+		return *this;
+	}
+
+	pool_ptr& operator=(std::nullptr_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	~pool_ptr() { reset(); }
+
+	/// @brief Returns the borrowed object to its pool, leaving the handle empty.
+	void reset() noexcept {
+		if (auto* n = std::exchange(node_, nullptr); n != nullptr) {
+			n->home()->deallocate(n);
+		}
+	}
+
+	void swap(pool_ptr& other) noexcept { std::swap(node_, other.node_); }
+
+	[[nodiscard]] T* get() const noexcept { return node_ != nullptr ? node_->data() : nullptr; }
+
+	T& operator*() const noexcept { return *node_->data(); }
+
+	T* operator->() const noexcept { return node_->data(); }
+
+	explicit operator bool() const noexcept { return node_ != nullptr; }
+
+	friend bool operator==(const pool_ptr& p, std::nullptr_t) noexcept { return p.node_ == nullptr; }
+
+	friend bool operator!=(const pool_ptr& p, std::nullptr_t) noexcept { return p.node_ != nullptr; }
+
+	friend bool operator==(std::nullptr_t, const pool_ptr& p) noexcept { return p.node_ == nullptr; }
+
+	friend bool operator!=(std::nullptr_t, const pool_ptr& p) noexcept { return p.node_ != nullptr; }
+};
+
+/// @brief Allocates an object from the pool without waiting.
 /// @tparam T The type T to allocate from the pool
-/// @return std::optional<std::shared_ptr<T>>
-template <typename T>
-[[nodiscard]] std::optional<std::shared_ptr<T>> object_pool<T>::allocate() {
-	auto node = do_allocate();
-	if (node != nullptr) {
-		return std::make_optional(std::shared_ptr<T>{node->data(), pool_deleter<T>{node}});
-	}
-	++waiters_;
-	std::unique_lock<std::mutex> lock{mutex_};
-	bool timeout = ready_.wait_for(lock, std::chrono::milliseconds{50}) == std::cv_status::timeout;
-	--waiters_;
-	if (!timeout) {
-		node = do_allocate();
-		if (node != nullptr) {
-			return std::make_optional(std::shared_ptr<T>{node->data(), pool_deleter<T>{node}});
-		}
-	}
-	return std::nullopt;
+/// @return pool_ptr<T>
+template <typename T, typename Concurrency>
+[[nodiscard]] pool_ptr<T, Concurrency> object_pool<T, Concurrency>::try_allocate() {
+	auto* n = acquire();
+	if (n == nullptr) { counters_.failed(); }
+	return pool_ptr<T, Concurrency>{n};
+}
+
+/// @brief Borrows up to count objects without waiting.
+/// @tparam T The type T to allocate from the pool
+/// @return std::size_t the number of objects written to out.
+template <typename T, typename Concurrency>
+template <typename OutputIt>
+std::size_t object_pool<T, Concurrency>::allocate_n(std::size_t count, OutputIt out) {
+	std::size_t borrowed = 0;
+	if constexpr (!is_mpmc) {
+		// Nothing to batch without a shared freelist, the nodes come off the borrower's own stack one by one.
+		for (; borrowed < count; ++borrowed) {
+			auto* n = prepare(pop_or_grow());
+			if (n == nullptr) { break; }
+			*out = pool_ptr<T, Concurrency>{n};
+			++out;
+		}
+		counters_.borrowed(borrowed);
+		return borrowed;
+	}
+	while (borrowed < count) {
+		std::size_t popped = 0;
+		auto* n = pop_chain(count - borrowed, popped);
+		if (n == nullptr) {
+			if (auto* f = take_fresh(); f != nullptr) {
+				*out = pool_ptr<T, Concurrency>{f};
+				++out;
+				++borrowed;
+				continue;
+			}
+			if (grow()) { continue; }
+			break;
+		}
+		while (n != nullptr) {
+			auto* next = node_at(links_[n->index()].load(std::memory_order_relaxed));
+			try {
+				*out = pool_ptr<T, Concurrency>{prepare(n)};
+				++out;
+			} catch (...) {
+				// The handle that failed to land already went back, return the rest of the chain with it.
+				push_list(next);
+				throw;
+			}
+			n = next;
+		}
+		borrowed += popped;
+	}
+	// Objects cached by this thread are invisible to the freelist, hand them out last.
+	if constexpr (is_mpmc) {
+		if (borrowed < count && magazine_size_ != 0) {
+			if (auto* mag = local_magazine(); mag != nullptr) {
+				for (; borrowed < count && !mag->empty(); ++borrowed) {
+					*out = pool_ptr<T, Concurrency>{prepare(mag->pop())};
+					++out;
+				}
+			}
+		}
+	}
+	counters_.borrowed(borrowed);
+	return borrowed;
+}
+
+/// @brief Returns the objects held by a range of pool_ptr<T> to the pool.
+/// @tparam T The type T to allocate from the pool
+template <typename T, typename Concurrency>
+template <typename Range>
+void object_pool<T, Concurrency>::deallocate_n(Range&& range) noexcept {
+	node* first = nullptr;
+	node* last = nullptr;
+	uint32_t count = 0;
+	for (auto& ptr : range) {
+		auto* n = std::exchange(ptr.node_, nullptr);
+		if (n == nullptr) { continue; }
+		if (n->home() != this) {
+			n->home()->deallocate(n);
+			continue;
+		}
+		counters_.returned(1);
+		if (recycle_ != pool_recycle::as_is && !recycle(n)) { continue; }
+		if (first != nullptr) { links_[n->index()].store(first->index(), std::memory_order_relaxed); }
+		if (last == nullptr) { last = n; }
+		first = n;
+		++count;
+	}
+	if (first == nullptr) { return; }
+	push_chain(first, last, count);
+	if (!chunks_.empty() && idle_release_ != std::chrono::milliseconds::max()) { maybe_trim(); }
 }
 
 } // end namespace genesis
@@ -0,0 +1,238 @@
+#if !defined GENESIS_RESIDENT_RESOURCE_HEADER_INCLUDED
+#define GENESIS_RESIDENT_RESOURCE_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/config.hpp"
+#include "genesis/errno.hpp"
+#include "genesis/hugepage_resource.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+#if GENESIS_POSIX
+#include <sys/mman.h>
+#elif GENESIS_MICROSOFT
+#include <windows.h>
+#endif
+
+namespace genesis {
+
+/// @brief Construction options for resident_resource.
+struct resident_resource_options {
+	/// @brief Fault in every page of an allocation before handing it out.
+	bool prefault{true};
+	/// @brief Lock allocations of a page or more into RAM with mlock, or VirtualLock on Windows, so they are never
+	/// paged out. Subject to RLIMIT_MEMLOCK, a lock that is refused is reported through error().
+	bool lock{false};
+};
+
+/// @brief Running totals of the work done by a resident_resource.
+struct resident_resource_stats {
+	/// @brief Bytes faulted in, allocations that are later freed stay counted.
+	std::size_t prefaulted_bytes{0};
+	/// @brief Bytes successfully locked, allocations that are later freed stay counted.
+	std::size_t locked_bytes{0};
+	/// @brief The number of prefault, lock, or unlock calls that failed.
+	std::size_t failures{0};
+};
+
+/// @brief Faults in the pages of [p, p + size) for writing, in one madvise(MADV_POPULATE_WRITE) call where the kernel
+/// supports it, otherwise by writing to every page. The contents of the range are unspecified afterwards.
+/// @param p Start of the range.
+/// @param size Size of the range in bytes.
+/// @param ec Set from the last error if the range could not be populated.
+/// @return bool true on success.
+inline bool prefault_pages(void* p, std::size_t size, std::error_code& ec) noexcept {
+	ec.clear();
+	if (p == nullptr || size == 0) { return true; }
+	auto page = details::system_page_size();
+#if GENESIS_LINUX && defined MADV_POPULATE_WRITE
+	if (reinterpret_cast<std::uintptr_t>(p) % page == 0) {
+		if (::madvise(p, details::round_up_to(size, page), MADV_POPULATE_WRITE) == 0) { return true; }
+		// Kernels before 5.14 don't know the advice, touching the pages still works there.
+		if (errno != EINVAL) {
+			assign_last_error(ec);
+			return false;
+		}
+	}
+#endif
+	auto* bytes = static_cast<volatile std::byte*>(p);
+	auto offset = reinterpret_cast<std::uintptr_t>(p) % page;
+	for (std::size_t i = 0; i < size; i += page - (i == 0 ? offset : 0)) { bytes[i] = std::byte{0}; }
+	bytes[size - 1] = std::byte{0};
+	return true;
+}
+
+/// @brief Locks the pages spanned by [p, p + size) into RAM.
+/// @param p Start of the range.
+/// @param size Size of the range in bytes.
+/// @param ec Set from the last error if the pages could not be locked.
+/// @return bool true on success.
+inline bool lock_pages(void* p, std::size_t size, std::error_code& ec) noexcept {
+	ec.clear();
+#if GENESIS_POSIX
+	if (::mlock(p, size) == 0) { return true; }
+#elif GENESIS_MICROSOFT
+	if (::VirtualLock(p, size) != 0) { return true; }
+#else
+	return true;
+#endif
+	assign_last_error(ec);
+	return false;
+}
+
+/// @brief Unlocks the pages spanned by [p, p + size), every page of the range is unlocked even if only part of
+/// it was locked for this range.
+/// @param p Start of the range.
+/// @param size Size of the range in bytes.
+/// @param ec Set from the last error if the pages could not be unlocked.
+/// @return bool true on success.
+inline bool unlock_pages(void* p, std::size_t size, std::error_code& ec) noexcept {
+	ec.clear();
+#if GENESIS_POSIX
+	if (::munlock(p, size) == 0) { return true; }
+#elif GENESIS_MICROSOFT
+	if (::VirtualUnlock(p, size) != 0) { return true; }
+#else
+	return true;
+#endif
+	assign_last_error(ec);
+	return false;
+}
+
+/// @brief The resident_resource class is a std::pmr::memory_resource adapter that prefaults, and optionally locks,
+/// the memory it takes from its upstream resource, so the first touch of a node doesn't page fault on the hot path.
+/// An object_pool built on it is fully resident once its constructor returns. Allocations of a page or more are
+/// rounded to whole pages and page aligned, so locking or unlocking one never affects another. Smaller ones, such
+/// as a pool's bookkeeping, are prefaulted but never locked. Prefault and lock failures never throw, the memory is
+/// handed out regardless and the failure is recorded for error(). Thread safe.
+class resident_resource : public std::pmr::memory_resource {
+private:
+	resident_resource_options options_;
+	std::pmr::memory_resource* upstream_;
+	std::atomic<std::size_t> prefaulted_bytes_;
+	std::atomic<std::size_t> locked_bytes_;
+	std::atomic<std::size_t> failures_;
+	mutable std::mutex error_mutex_;
+	std::error_code error_;  // Guarded by error_mutex_
+
+public:
+	/// @brief Construct a new resident_resource object.
+	/// @param opts The options for the resource, see resident_resource_options.
+	/// @param upstream The resource memory is taken from.
+	explicit resident_resource(
+		const resident_resource_options& opts = {},
+		std::pmr::memory_resource* upstream = std::pmr::get_default_resource()
+	) noexcept :
+		options_{opts},
+		upstream_{upstream},
+		prefaulted_bytes_{0},
+		locked_bytes_{0},
+		failures_{0},
+		error_mutex_{},
+		error_{}
+	{ }
+
+	/// @brief Construct a new resident_resource object with the default options.
+	/// @param upstream The resource memory is taken from.
+	explicit resident_resource(std::pmr::memory_resource* upstream) noexcept :
+		resident_resource{resident_resource_options{}, upstream}
+	{ }
+
+	resident_resource(const resident_resource&) = delete;
+
+	resident_resource& operator=(const resident_resource&) = delete;
+
+	/// @brief Upstream observor for resident_resource.
+	/// @return std::pmr::memory_resource* the resource memory is taken from.
+	[[nodiscard]] std::pmr::memory_resource* upstream_resource() const noexcept { return upstream_; }
+
+	/// @brief Takes a snapshot of the running totals.
+	/// @return resident_resource_stats
+	[[nodiscard]] resident_resource_stats stats() const noexcept {
+		return {
+			prefaulted_bytes_.load(std::memory_order_relaxed),
+			locked_bytes_.load(std::memory_order_relaxed),
+			failures_.load(std::memory_order_relaxed)
+		};
+	}
+
+	/// @brief The most recent prefault, lock, or unlock failure.
+	/// @return std::error_code empty if nothing failed since construction or the last clear_error().
+	[[nodiscard]] std::error_code error() const {
+		std::scoped_lock lock{error_mutex_};
+		return error_;
+	}
+
+	/// @brief Forgets the recorded failure.
+	void clear_error() {
+		std::scoped_lock lock{error_mutex_};
+		error_.clear();
+	}
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		auto [size, align] = upstream_request(bytes, alignment);
+		auto* p = upstream_->allocate(size, align);
+		std::error_code ec{};
+		if (options_.prefault) {
+			if (prefault_pages(p, size, ec)) {
+				prefaulted_bytes_.fetch_add(size, std::memory_order_relaxed);
+			} else {
+				record(ec);
+			}
+		}
+		if (locks(size)) {
+			if (lock_pages(p, size, ec)) {
+				locked_bytes_.fetch_add(size, std::memory_order_relaxed);
+			} else {
+				record(ec);
+			}
+		}
+		return p;
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+		auto [size, align] = upstream_request(bytes, alignment);
+		if (locks(size)) {
+			// Harmless if the lock was refused, the pages belong to this allocation alone.
+			if (std::error_code ec{}; !unlock_pages(p, size, ec)) { record(ec); }
+		}
+		upstream_->deallocate(p, size, align);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	/// @brief The size and alignment asked of the upstream resource, whole pages for allocations of a page or more.
+	[[nodiscard]] static std::pair<std::size_t, std::size_t> upstream_request(std::size_t bytes, std::size_t alignment) noexcept {
+		auto page = details::system_page_size();
+		if (bytes < page) { return {bytes, alignment}; }
+		return {details::round_up_to(bytes, page), std::max(alignment, page)};
+	}
+
+	[[nodiscard]] bool locks(std::size_t size) const noexcept {
+		return options_.lock && size >= details::system_page_size();
+	}
+
+	void record(const std::error_code& ec) noexcept {
+		failures_.fetch_add(1, std::memory_order_relaxed);
+		try {
+			std::scoped_lock lock{error_mutex_};
+			error_ = ec;
+		} catch (...) {
+			// The failure is still counted.
+		}
+	}
+};
+
+} // end namespace genesis
+
+#endif
@@ -0,0 +1,421 @@
+#if !defined GENESIS_SHARDED_OBJECT_POOL_HEADER_INCLUDED
+#define GENESIS_SHARDED_OBJECT_POOL_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/details/thread.hpp"
+#include "genesis/memory.hpp"
+#include "genesis/object_pool.hpp"
+#include "genesis/stop_token.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+namespace genesis {
+
+namespace details {
+
+/// @brief One shard of a sharded_object_pool, kept on its own cache lines so the freelist heads of
+/// neighbouring shards never share one.
+template <typename T>
+struct alignas(hardware_destructive_interference_size) pool_shard {
+	using node = typename object_pool<T>::node;
+
+	/// @brief The most nodes a shard without magazines takes from a neighbour in one steal.
+	static constexpr std::size_t steal_batch = 8;
+
+	object_pool<T> pool_;
+	// Nodes stolen from other shards that the borrowers of this shard take before stealing again.
+	// They still belong to the shard they were stolen from and go back to it when they are returned.
+	std::array<node*, steal_batch> stash_;  // Guarded by stash_mutex_
+	std::atomic<std::size_t> stashed_;  // Written under stash_mutex_, read without it to skip an empty stash
+	std::mutex stash_mutex_;
+
+	pool_shard(const object_pool_options& opts, const std::function<T()>& gen, std::pmr::memory_resource* mem_resource) :
+		pool_{opts, gen, mem_resource},
+		stash_{},
+		stashed_{0},
+		stash_mutex_{}
+	{ }
+};
+
+} // end namespace details
+
+/// @brief The sharded_object_pool class splits its objects over one object_pool shard per CPU, so threads
+/// running on different CPUs borrow from and return to different freelists. A thread borrows from the shard
+/// of the CPU it runs on, and steals from the neighbouring shards once that one is empty. Every object
+/// belongs to one shard for its whole life and always goes back to it, whichever thread returns it.
+/// A borrower that finds every shard exhausted waits on the whole pool, so a return to any shard wakes it.
+/// Those waiters don't queue in line, pool_fairness::fifo only applies to borrowers of a single shard.
+/// @tparam T The type to allocate in the pool
+template <typename T>
+class sharded_object_pool {
+public:
+	using node = typename object_pool<T>::node;
+
+private:
+	using shard = details::pool_shard<T>;
+	using clock = std::chrono::steady_clock;
+
+	// How long allocate and allocate_unique wait on an exhausted pool.
+	static constexpr std::chrono::milliseconds default_wait{50};
+
+	static constexpr std::size_t steal_batch = shard::steal_batch;
+
+	std::pmr::polymorphic_allocator<std::byte> allocator_;
+	shard* shards_;
+	std::size_t shard_count_;
+	details::pool_group group_;  // Borrowers waiting on the whole pool, woken by a return to any shard
+	// Waits and failures of borrows from the whole pool, which no single shard sees.
+	std::conditional_t<GENESIS_OBJECT_POOL_STATS != 0, details::pool_counters<object_pool_padding_v<T>>, details::no_pool_counters> counters_;
+
+public:
+	/// @brief Construct a new sharded_object_pool object with one shard per hardware thread.
+	/// @tparam Generator Function that returns a object type T.
+	/// @param init_capacity The initial capacity, split evenly over the shards.
+	/// @param gen The generator function that must return an object of type T.
+	/// @param mem_resource The memory resource in which to do the allocations.
+	template <
+		typename Generator,
+		std::enable_if_t<std::is_invocable_r_v<T, Generator>, int> = 0
+	>
+	sharded_object_pool(
+		std::size_t init_capacity,
+		Generator gen,
+		std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()
+	) :
+		sharded_object_pool{object_pool_options{init_capacity}, default_shard_count(), std::move(gen), mem_resource}
+	{ }
+
+	/// @brief Construct a new sharded_object_pool object from a set of options.
+	/// The capacity, maximum capacity and chunk size are split evenly over the shards, every shard gets the
+	/// full magazine size. With magazines a steal takes a batch of up to half a magazine into the thread's
+	/// magazine, without them a batch of up to eight objects goes into the stealing shard's stash.
+	/// @tparam Generator Function that returns a object type T.
+	/// @param opts The options for the whole pool, see object_pool_options.
+	/// @param init_shard_count The number of shards, must be at least one.
+	/// @param gen The generator function that must return an object of type T.
+	/// @param mem_resource The memory resource in which to do the allocations.
+	template <
+		typename Generator,
+		std::enable_if_t<std::is_invocable_r_v<T, Generator>, int> = 0
+	>
+	sharded_object_pool(
+		const object_pool_options& opts,
+		std::size_t init_shard_count,
+		Generator gen,
+		std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()
+	) :
+		allocator_{mem_resource},
+		shards_{nullptr},
+		shard_count_{checked_shard_count(init_shard_count)},
+		group_{},
+		counters_{}
+	{
+		build_shards(opts, std::function<T()>{std::move(gen)});
+	}
+
+	/// @brief Construct a new sharded_object_pool object from a set of options with all objects being constructed
+	/// with the default constructor of type T.
+	/// @param opts The options for the whole pool, see object_pool_options.
+	/// @param init_shard_count The number of shards, must be at least one.
+	/// @param mem_resource The memory resource in which to do the allocations.
+	sharded_object_pool(
+		const object_pool_options& opts,
+		std::size_t init_shard_count,
+		std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()
+	) :
+		sharded_object_pool{opts, init_shard_count, []() { return T{}; }, mem_resource}
+	{ }
+
+	/// @brief Construct a new sharded_object_pool object with one shard per hardware thread, all objects being
+	/// constructed with the default constructor of type T.
+	/// @param init_capacity The initial capacity, split evenly over the shards.
+	/// @param mem_resource The memory resource in which to do the allocations.
+	explicit sharded_object_pool(std::size_t init_capacity, std::pmr::memory_resource* mem_resource = std::pmr::get_default_resource()) :
+		sharded_object_pool{object_pool_options{init_capacity}, default_shard_count(), mem_resource}
+	{ }
+
+	~sharded_object_pool() { destroy_shards(shard_count_); }
+
+	sharded_object_pool(const sharded_object_pool&) = delete;
+
+	sharded_object_pool(sharded_object_pool&&) = delete;
+
+	sharded_object_pool& operator=(const sharded_object_pool&) = delete;
+
+	sharded_object_pool& operator=(sharded_object_pool&&) = delete;
+
+	/// @brief The number of objects the shards currently hold, borrowed or not.
+	[[nodiscard]] std::size_t capacity() const noexcept {
+		std::size_t total = 0;
+		for (std::size_t i = 0; i < shard_count_; ++i) { total += shards_[i].pool_.capacity(); }
+		return total;
+	}
+
+	/// @brief The number of objects the shards may grow to together.
+	[[nodiscard]] std::size_t max_capacity() const noexcept {
+		std::size_t total = 0;
+		for (std::size_t i = 0; i < shard_count_; ++i) { total += shards_[i].pool_.max_capacity(); }
+		return total;
+	}
+
+	[[nodiscard]] std::size_t shard_count() const noexcept { return shard_count_; }
+
+	/// @brief The number of free objects the shards hold in their stashes, stolen from a neighbour but not yet
+	/// handed out. They are only visible to the borrowers of the pool, not to the shard they were stolen from.
+	[[nodiscard]] std::size_t stashed() const noexcept {
+		std::size_t total = 0;
+		for (std::size_t i = 0; i < shard_count_; ++i) { total += shards_[i].stashed_.load(std::memory_order_relaxed); }
+		return total;
+	}
+
+	/// @brief Allocates an object from the pool, waiting up to 50ms for one to be returned if the pool is exhausted.
+	/// @return std::optional<std::shared_ptr<T>> std::nullopt if no object became available.
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate() { return allocate_for(default_wait); }
+
+	/// @brief Allocates an object from the pool, waiting until an object is returned or a stop is requested.
+	/// @param token Stop token that cancels the wait.
+	/// @return std::optional<std::shared_ptr<T>> std::nullopt if stop was requested before an object was returned.
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate(inplace_stop_token token) {
+		return object_pool<T>::make_shared(acquire_until(clock::time_point::max(), token));
+	}
+
+	/// @brief Allocates an object from the pool, waiting at most rel_time for one to be returned.
+	/// @param rel_time The longest time to wait for.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return std::optional<std::shared_ptr<T>> std::nullopt on timeout or stop.
+	template <typename Rep, typename Period>
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate_for(
+		const std::chrono::duration<Rep, Period>& rel_time,
+		inplace_stop_token token = {}
+	) {
+		return object_pool<T>::make_shared(acquire_until(object_pool<T>::deadline_after(rel_time), token));
+	}
+
+	/// @brief Allocates an object from the pool, waiting until abs_time at the latest for one to be returned.
+	/// @param abs_time The point in time to stop waiting at.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return std::optional<std::shared_ptr<T>> std::nullopt on timeout or stop.
+	template <typename Clock, typename Duration>
+	[[nodiscard]] std::optional<std::shared_ptr<T>> allocate_until(
+		const std::chrono::time_point<Clock, Duration>& abs_time,
+		inplace_stop_token token = {}
+	) {
+		return object_pool<T>::make_shared(acquire_until(object_pool<T>::deadline_at(abs_time), token));
+	}
+
+	/// @brief Allocates an object from the pool, waiting up to 50ms for one to be returned if the pool is exhausted.
+	/// @return pool_ptr<T> the borrowed object, empty if none became available.
+	[[nodiscard]] pool_ptr<T> allocate_unique() { return allocate_unique_for(default_wait); }
+
+	/// @brief Allocates an object from the pool, waiting until an object is returned or a stop is requested.
+	/// @param token Stop token that cancels the wait.
+	/// @return pool_ptr<T> the borrowed object, empty if stop was requested before an object was returned.
+	[[nodiscard]] pool_ptr<T> allocate_unique(inplace_stop_token token) {
+		return pool_ptr<T>{acquire_until(clock::time_point::max(), token)};
+	}
+
+	/// @brief Allocates an object from the pool, waiting at most rel_time for one to be returned.
+	/// @param rel_time The longest time to wait for.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return pool_ptr<T> the borrowed object, empty on timeout or stop.
+	template <typename Rep, typename Period>
+	[[nodiscard]] pool_ptr<T> allocate_unique_for(const std::chrono::duration<Rep, Period>& rel_time, inplace_stop_token token = {}) {
+		return pool_ptr<T>{acquire_until(object_pool<T>::deadline_after(rel_time), token)};
+	}
+
+	/// @brief Allocates an object from the pool, waiting until abs_time at the latest for one to be returned.
+	/// @param abs_time The point in time to stop waiting at.
+	/// @param token Optional stop token that cancels the wait early.
+	/// @return pool_ptr<T> the borrowed object, empty on timeout or stop.
+	template <typename Clock, typename Duration>
+	[[nodiscard]] pool_ptr<T> allocate_unique_until(const std::chrono::time_point<Clock, Duration>& abs_time, inplace_stop_token token = {}) {
+		return pool_ptr<T>{acquire_until(object_pool<T>::deadline_at(abs_time), token)};
+	}
+
+	/// @brief Allocates an object from the pool without waiting.
+	/// @return pool_ptr<T> the borrowed object, empty if every shard is exhausted.
+	[[nodiscard]] pool_ptr<T> try_allocate() {
+		auto* n = acquire();
+		if (n == nullptr) { counters_.failed(); }
+		return pool_ptr<T>{n};
+	}
+
+	/// @brief Returns a node to the shard that owns it.
+	/// @param n The node to return.
+	void deallocate(node* n) noexcept {
+		if (n != nullptr) { n->home()->deallocate(n); }
+	}
+
+	/// @brief Takes a snapshot of the counters of every shard added together, see object_pool::stats. Waits and
+	/// failures are counted for the pool as a whole.
+	/// @return object_pool_stats all counters but the capacity are zero unless GENESIS_OBJECT_POOL_STATS is 1.
+	[[nodiscard]] object_pool_stats stats() noexcept {
+		object_pool_stats total{};
+		for (std::size_t i = 0; i < shard_count_; ++i) { total += shards_[i].pool_.stats(); }
+		object_pool_stats own{};
+		counters_.snapshot(own);
+		total.waits += own.waits;
+		total.failures += own.failures;
+		for (std::size_t i = 0; i < object_pool_stats::wait_buckets; ++i) { total.wait_histogram[i] += own.wait_histogram[i]; }
+		return total;
+	}
+
+	/// @brief Releases idle grown chunks of every shard, see object_pool::trim.
+	/// @return std::size_t the number of objects released.
+	std::size_t trim() noexcept {
+		std::size_t released = 0;
+		for (std::size_t i = 0; i < shard_count_; ++i) { released += shards_[i].pool_.trim(); }
+		return released;
+	}
+
+private:
+	[[nodiscard]] static std::size_t default_shard_count() noexcept {
+		return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	[[nodiscard]] static std::size_t checked_shard_count(std::size_t count) {
+		if (count == 0) { throw std::invalid_argument{"sharded_object_pool needs at least one shard"}; }
+		return count;
+	}
+
+	/// @brief The share of total that shard i gets, the remainder goes to the first shards.
+	[[nodiscard]] std::size_t share(std::size_t total, std::size_t i) const noexcept {
+		return total / shard_count_ + (i < total % shard_count_ ? 1 : 0);
+	}
+
+	void build_shards(const object_pool_options& opts, const std::function<T()>& gen) {
+		shards_ = static_cast<shard*>(allocator_.resource()->allocate(shard_count_ * sizeof(shard), alignof(shard)));
+		std::size_t constructed = 0;
+		try {
+			for (; constructed < shard_count_; ++constructed) {
+				auto shard_opts = opts;
+				shard_opts.capacity = share(opts.capacity, constructed);
+				shard_opts.max_capacity = share(std::max(opts.max_capacity, opts.capacity), constructed);
+				if (opts.chunk_size != 0) { shard_opts.chunk_size = std::max<std::size_t>(share(opts.chunk_size, constructed), 1); }
+				genesis::construct_at(shards_ + constructed, shard_opts, gen, allocator_.resource())->pool_.group_ = &group_;
+			}
+		} catch (...) {
+			destroy_shards(constructed);
+			throw;
+		}
+	}
+
+	void destroy_shards(std::size_t constructed) noexcept {
+		for (std::size_t i = 0; i < constructed; ++i) { std::destroy_at(shards_ + i); }
+		allocator_.resource()->deallocate(shards_, shard_count_ * sizeof(shard), alignof(shard));
+	}
+
+	[[nodiscard]] std::size_t local_index() const noexcept {
+		return shard_count_ == 1 ? 0 : details::current_cpu() % shard_count_;
+	}
+
+	/// @brief Borrows from the local shard, growing it if it is elastic, then steals from the others in turn.
+	/// Other shards are only grown once the local one is at its maximum and nothing is left to steal.
+	node* acquire() {
+		auto local = local_index();
+		auto& home = shards_[local];
+		if (auto* n = home.pool_.acquire(); n != nullptr) { return n; }
+		if (auto* n = unstash(home); n != nullptr) { return n; }
+		for (std::size_t i = 1; i < shard_count_; ++i) {
+			auto& victim = shards_[neighbour(local, i)];
+			if (auto* n = steal(home, victim.pool_); n != nullptr) { return n; }
+			if (auto* n = unstash(victim); n != nullptr) { return n; }
+		}
+		for (std::size_t i = 1; i < shard_count_; ++i) {
+			auto& victim = shards_[neighbour(local, i)].pool_;
+			if (victim.capacity() == victim.max_capacity()) { continue; }
+			if (auto* n = victim.acquire(); n != nullptr) { return n; }
+		}
+		return nullptr;
+	}
+
+	/// @brief Takes a batch of free objects from a neighbouring shard with a single CAS on its freelist, hands
+	/// out one and stashes the rest in the stealing shard so its next borrows don't go back to the neighbour.
+	node* steal(shard& thief, object_pool<T>& victim) {
+		if (victim.magazine_size() != 0) {
+			if (auto* n = victim.steal(); n != nullptr) { return n; }
+		}
+		std::array<node*, steal_batch> batch{};
+		auto stolen = victim.steal_n(steal_batch, batch.data());
+		if (stolen == 0) { return nullptr; }
+		std::size_t kept = 1;
+		{
+			std::scoped_lock lock{thief.stash_mutex_};
+			auto stashed = thief.stashed_.load(std::memory_order_relaxed);
+			for (; kept < stolen && stashed < steal_batch; ++kept) { thief.stash_[stashed++] = batch[kept]; }
+			thief.stashed_.store(stashed, std::memory_order_relaxed);
+		}
+		// Whatever didn't fit goes straight back, that wakes waiters on its own.
+		victim.unsteal_n(batch.data() + kept, stolen - kept);
+		if (kept > 1) {
+			// Pairs with the fence in acquire_until, either this sees the waiter or the waiter sees the stash.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (group_.waiters_->load(std::memory_order_relaxed) > 0) { group_.wake(static_cast<uint32_t>(kept - 1)); }
+		}
+		return victim.lend(batch[0]);
+	}
+
+	/// @brief Hands out an object from the stash of a shard.
+	/// @return node* nullptr if the stash is empty.
+	static node* unstash(shard& s) {
+		if (s.stashed_.load(std::memory_order_relaxed) == 0) { return nullptr; }
+		node* n = nullptr;
+		{
+			std::scoped_lock lock{s.stash_mutex_};
+			auto stashed = s.stashed_.load(std::memory_order_relaxed);
+			if (stashed == 0) { return nullptr; }
+			n = s.stash_[stashed - 1];
+			s.stashed_.store(stashed - 1, std::memory_order_relaxed);
+		}
+		return n->home()->lend(n);
+	}
+
+	[[nodiscard]] std::size_t neighbour(std::size_t local, std::size_t distance) const noexcept {
+		return local + distance < shard_count_ ? local + distance : local + distance - shard_count_;
+	}
+
+	/// @brief Wakes every borrower parked on the pool so it can notice that its stop token was triggered.
+	struct stop_waker {
+		details::pool_group* group_;
+
+		void operator()() const noexcept { group_->wake(UINT32_MAX); }
+	};
+
+	/// @brief Borrows a node, parking on the whole pool while every shard is exhausted until the deadline or a stop request.
+	node* acquire_until(clock::time_point deadline, inplace_stop_token token) {
+		auto* n = acquire();
+		if (n == nullptr && !token.stop_requested()) {
+			[[maybe_unused]] auto wait_start = GENESIS_OBJECT_POOL_STATS != 0 ? clock::now() : clock::time_point{};
+			inplace_stop_callback<stop_waker> on_stop{token, stop_waker{&group_}};
+			group_.waiters_->fetch_add(1, std::memory_order_seq_cst);
+			// Pairs with the check after every return to a shard, either that sees this waiter or this sees the object.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			while (true) {
+				auto seq = group_.wake_seq_.load(std::memory_order_acquire);
+				n = acquire();
+				if (n != nullptr || token.stop_requested() || clock::now() >= deadline) { break; }
+				details::atomic_wait_until(group_.wake_seq_, seq, deadline);
+			}
+			group_.waiters_->fetch_sub(1, std::memory_order_relaxed);
+			if constexpr (GENESIS_OBJECT_POOL_STATS != 0) { counters_.waited(clock::now() - wait_start); }
+		}
+		if (n == nullptr) { counters_.failed(); }
+		return n;
+	}
+};
+
+} // end namespace genesis
+
+#endif
@@ -0,0 +1,609 @@
+#if !defined GENESIS_SMALL_VECTOR_HEADER_INCLUDED
+#define GENESIS_SMALL_VECTOR_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/memory.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace genesis {
+
+namespace details {
+
+/// @brief Holds the allocator of a small_vector, taking no space for stateless allocators such as std::allocator.
+template <typename Allocator, bool = std::is_empty_v<Allocator> && !std::is_final_v<Allocator>>
+class allocator_holder : private Allocator {
+protected:
+	explicit allocator_holder(const Allocator& init_alloc) noexcept : Allocator{init_alloc} { }
+
+	Allocator& allocator() noexcept { return *this; }
+
+	const Allocator& allocator() const noexcept { return *this; }
+};
+
+template <typename Allocator>
+class allocator_holder<Allocator, false> {
+private:
+	Allocator alloc_;
+
+protected:
+	explicit allocator_holder(const Allocator& init_alloc) noexcept : alloc_{init_alloc} { }
+
+	Allocator& allocator() noexcept { return alloc_; }
+
+	const Allocator& allocator() const noexcept { return alloc_; }
+};
+
+/// @brief Inline element storage of a small_vector, a byte of padding stands in when N is 0.
+template <typename T, std::size_t N>
+struct small_vector_storage {
+	alignas(T) std::byte bytes_[N == 0 ? 1 : N * sizeof(T)];
+};
+
+} // end namespace details
+
+/// @brief The small_vector class is a contiguous sequence container that keeps up to N elements inline and only
+/// takes memory from its allocator once it outgrows them, so short lists cost no allocation at all. Growth
+/// relocates the elements with uninitialized_relocate, a single memcpy for trivially relocatable types. Unlike
+/// std::vector, moving a small_vector whose elements are inline moves the elements one by one and swapping two is
+/// linear in their size.
+/// @tparam T The element type.
+/// @tparam N The number of elements stored inline.
+/// @tparam Allocator The allocator for the elements once they spill over the inline storage.
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class small_vector : private details::allocator_holder<Allocator> {
+private:
+	using holder = details::allocator_holder<Allocator>;
+	using alloc_traits = std::allocator_traits<Allocator>;
+
+	static_assert(std::is_same_v<typename alloc_traits::value_type, T>, "small_vector allocator must allocate T");
+
+public:
+	using value_type = T;
+	using allocator_type = Allocator;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using pointer = T*;
+	using const_pointer = const T*;
+	using iterator = T*;
+	using const_iterator = const T*;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	/// @brief The number of elements stored inline.
+	static constexpr size_type inline_capacity = N;
+
+private:
+	T* data_;
+	size_type size_;
+	size_type capacity_;
+	details::small_vector_storage<T, N> storage_;
+
+public:
+	small_vector() noexcept(noexcept(Allocator{})) :
+		small_vector{Allocator{}}
+	{ }
+
+	explicit small_vector(const Allocator& alloc) noexcept :
+		holder{alloc},
+		data_{inline_data()},
+		size_{0},
+		capacity_{N}
+	{ }
+
+	explicit small_vector(size_type count, const Allocator& alloc = Allocator{}) :
+		small_vector{alloc}
+	{
+		resize(count);
+	}
+
+	small_vector(size_type count, const T& value, const Allocator& alloc = Allocator{}) :
+		small_vector{alloc}
+	{
+		assign(count, value);
+	}
+
+	template <
+		typename InputIt,
+		std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>, int> = 0
+	>
+	small_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator{}) :
+		small_vector{alloc}
+	{
+		assign(first, last);
+	}
+
+	small_vector(std::initializer_list<T> init, const Allocator& alloc = Allocator{}) :
+		small_vector{alloc}
+	{
+		assign(init.begin(), init.end());
+	}
+
+	small_vector(const small_vector& other) :
+		small_vector{other, alloc_traits::select_on_container_copy_construction(other.allocator())}
+	{ }
+
+	small_vector(const small_vector& other, const Allocator& alloc) :
+		small_vector{alloc}
+	{
+		assign(other.begin(), other.end());
+	}
+
+	small_vector(small_vector&& other) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) :
+		small_vector{std::move(other.allocator())}
+	{
+		take(other);
+	}
+
+	small_vector(small_vector&& other, const Allocator& alloc) :
+		small_vector{alloc}
+	{
+		if (allocator() == other.allocator()) {
+			take(other);
+		} else {
+			assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+			other.clear();
+		}
+	}
+
+	~small_vector() {
+		genesis::destroy_n(data_, size_);
+		release();
+	}
+
+	small_vector& operator=(const small_vector& other) {
+		if (this == &other) { return *this; }
+		if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+			if (allocator() != other.allocator()) {
+				clear();
+				release();
+			}
+			allocator() = other.allocator();
+		}
+		assign(other.begin(), other.end());
+		return *this;
+	}
+
+	small_vector& operator=(small_vector&& other) noexcept(
+		(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) &&
+		(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+	) {
+		if (this == &other) { return *this; }
+		clear();
+		if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+			release();
+			allocator() = std::move(other.allocator());
+			take(other);
+		} else {
+			if (allocator() == other.allocator()) {
+				release();
+				take(other);
+			} else {
+				assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+				other.clear();
+			}
+		}
+		return *this;
+	}
+
+	small_vector& operator=(std::initializer_list<T> init) {
+		assign(init.begin(), init.end());
+		return *this;
+	}
+
+	/// @brief Replaces the contents with count copies of value.
+	void assign(size_type count, const T& value) {
+		if (count > capacity_) {
+			// Fill the new storage before clearing, value may be an element.
+			auto* new_data = alloc_traits::allocate(allocator(), count);
+			try {
+				genesis::uninitialized_fill_n(new_data, count, value);
+			} catch (...) {
+				alloc_traits::deallocate(allocator(), new_data, count);
+				throw;
+			}
+			clear();
+			adopt(new_data, count);
+			size_ = count;
+			return;
+		}
+		auto common = std::min(count, size_);
+		std::fill_n(data_, common, value);
+		if (count > size_) {
+			genesis::uninitialized_fill_n(data_ + size_, count - size_, value);
+		} else {
+			genesis::destroy_n(data_ + count, size_ - count);
+		}
+		size_ = count;
+	}
+
+	/// @brief Replaces the contents with the elements of [first, last).
+	template <
+		typename InputIt,
+		std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>, int> = 0
+	>
+	void assign(InputIt first, InputIt last) {
+		clear();
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+			auto count = static_cast<size_type>(std::distance(first, last));
+			reserve(count);
+			std::uninitialized_copy(first, last, data_);
+			size_ = count;
+		} else {
+			for (; first != last; ++first) { emplace_back(*first); }
+		}
+	}
+
+	void assign(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+
+	[[nodiscard]] allocator_type get_allocator() const noexcept { return allocator(); }
+
+	[[nodiscard]] reference at(size_type pos) {
+		if (pos >= size_) { throw std::out_of_range{"small_vector index out of range"}; }
+		return data_[pos];
+	}
+
+	[[nodiscard]] const_reference at(size_type pos) const {
+		if (pos >= size_) { throw std::out_of_range{"small_vector index out of range"}; }
+		return data_[pos];
+	}
+
+	[[nodiscard]] reference operator[](size_type pos) noexcept { return data_[pos]; }
+
+	[[nodiscard]] const_reference operator[](size_type pos) const noexcept { return data_[pos]; }
+
+	[[nodiscard]] reference front() noexcept { return data_[0]; }
+
+	[[nodiscard]] const_reference front() const noexcept { return data_[0]; }
+
+	[[nodiscard]] reference back() noexcept { return data_[size_ - 1]; }
+
+	[[nodiscard]] const_reference back() const noexcept { return data_[size_ - 1]; }
+
+	[[nodiscard]] T* data() noexcept { return data_; }
+
+	[[nodiscard]] const T* data() const noexcept { return data_; }
+
+	[[nodiscard]] iterator begin() noexcept { return data_; }
+
+	[[nodiscard]] const_iterator begin() const noexcept { return data_; }
+
+	[[nodiscard]] const_iterator cbegin() const noexcept { return data_; }
+
+	[[nodiscard]] iterator end() noexcept { return data_ + size_; }
+
+	[[nodiscard]] const_iterator end() const noexcept { return data_ + size_; }
+
+	[[nodiscard]] const_iterator cend() const noexcept { return data_ + size_; }
+
+	[[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+
+	[[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+
+	[[nodiscard]] const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator{end()}; }
+
+	[[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+
+	[[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+
+	[[nodiscard]] const_reverse_iterator crend() const noexcept { return const_reverse_iterator{begin()}; }
+
+	[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+	[[nodiscard]] size_type size() const noexcept { return size_; }
+
+	[[nodiscard]] size_type max_size() const noexcept {
+		return std::min<size_type>(alloc_traits::max_size(allocator()), std::numeric_limits<difference_type>::max() / sizeof(T));
+	}
+
+	[[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+	/// @brief Whether the elements are in the inline storage rather than memory from the allocator.
+	[[nodiscard]] bool is_inline() const noexcept { return data_ == inline_data(); }
+
+	/// @brief Makes room for at least new_capacity elements without further allocation.
+	void reserve(size_type new_capacity) {
+		if (new_capacity > capacity_) { reallocate(new_capacity); }
+	}
+
+	/// @brief Moves the elements back inline if they fit, or into an allocation of exactly their size otherwise.
+	void shrink_to_fit() {
+		if (is_inline() || size_ == capacity_) { return; }
+		if (size_ <= N) {
+			auto* old_data = data_;
+			auto old_capacity = capacity_;
+			relocate_elements(old_data, size_, inline_data());
+			data_ = inline_data();
+			capacity_ = N;
+			alloc_traits::deallocate(allocator(), old_data, old_capacity);
+		} else {
+			reallocate(size_);
+		}
+	}
+
+	void clear() noexcept {
+		genesis::destroy_n(data_, size_);
+		size_ = 0;
+	}
+
+	iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+
+	iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+	/// @brief Inserts count copies of value before pos.
+	iterator insert(const_iterator pos, size_type count, const T& value) {
+		auto index = static_cast<size_type>(pos - begin());
+		if (count == 0) { return begin() + index; }
+		// value may be an element, copy it before anything moves.
+		T copy(value);
+		auto old_size = size_;
+		if (size_ + count > capacity_) { reserve(grown_capacity(size_ + count)); }
+		append_fill(count, copy);
+		std::rotate(begin() + index, begin() + old_size, end());
+		return begin() + index;
+	}
+
+	/// @brief Inserts the elements of [first, last) before pos.
+	template <
+		typename InputIt,
+		std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>, int> = 0
+	>
+	iterator insert(const_iterator pos, InputIt first, InputIt last) {
+		auto index = static_cast<size_type>(pos - begin());
+		auto old_size = size_;
+		for (; first != last; ++first) { emplace_back(*first); }
+		std::rotate(begin() + index, begin() + old_size, end());
+		return begin() + index;
+	}
+
+	iterator insert(const_iterator pos, std::initializer_list<T> init) { return insert(pos, init.begin(), init.end()); }
+
+	/// @brief Constructs an element in place before pos.
+	template <typename... Args>
+	iterator emplace(const_iterator pos, Args&&... args) {
+		auto index = static_cast<size_type>(pos - begin());
+		if (index == size_) {
+			emplace_back(std::forward<Args>(args)...);
+		} else if (size_ < capacity_) {
+			// Build the element first, the arguments may refer to elements about to move.
+			T value(std::forward<Args>(args)...);
+			genesis::construct_at(data_ + size_, std::move(data_[size_ - 1]));
+			++size_;
+			std::move_backward(data_ + index, data_ + size_ - 2, data_ + size_ - 1);
+			data_[index] = std::move(value);
+		} else {
+			grow_and_emplace(index, std::forward<Args>(args)...);
+		}
+		return begin() + index;
+	}
+
+	void push_back(const T& value) { emplace_back(value); }
+
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+
+	template <typename... Args>
+	reference emplace_back(Args&&... args) {
+		if (size_ == capacity_) {
+			grow_and_emplace(size_, std::forward<Args>(args)...);
+		} else {
+			genesis::construct_at(data_ + size_, std::forward<Args>(args)...);
+			++size_;
+		}
+		return back();
+	}
+
+	void pop_back() noexcept {
+		--size_;
+		std::destroy_at(data_ + size_);
+	}
+
+	iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+	iterator erase(const_iterator first, const_iterator last) {
+		auto index = static_cast<size_type>(first - begin());
+		auto count = static_cast<size_type>(last - first);
+		if (count != 0) {
+			auto new_end = std::move(begin() + index + count, end(), begin() + index);
+			genesis::destroy_n(new_end, count);
+			size_ -= count;
+		}
+		return begin() + index;
+	}
+
+	void resize(size_type count) {
+		if (count > size_) {
+			reserve(count);
+			genesis::uninitialized_value_construct_n(data_ + size_, count - size_);
+		} else {
+			genesis::destroy_n(data_ + count, size_ - count);
+		}
+		size_ = count;
+	}
+
+	void resize(size_type count, const T& value) {
+		if (count > size_) {
+			T copy(value);
+			reserve(count);
+			append_fill(count - size_, copy);
+		} else {
+			genesis::destroy_n(data_ + count, size_ - count);
+			size_ = count;
+		}
+	}
+
+	void swap(small_vector& other) noexcept(
+		(alloc_traits::propagate_on_container_swap::value || alloc_traits::is_always_equal::value) &&
+		(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+	) {
+		if (this == &other) { return; }
+		if constexpr (alloc_traits::propagate_on_container_swap::value) {
+			using std::swap;
+			swap(allocator(), other.allocator());
+		}
+		swap_storage(other);
+	}
+
+	friend void swap(small_vector& lhs, small_vector& rhs) noexcept(noexcept(lhs.swap(rhs))) { lhs.swap(rhs); }
+
+	friend bool operator==(const small_vector& lhs, const small_vector& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	friend bool operator!=(const small_vector& lhs, const small_vector& rhs) { return !(lhs == rhs); }
+
+	friend bool operator<(const small_vector& lhs, const small_vector& rhs) {
+		return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	friend bool operator>(const small_vector& lhs, const small_vector& rhs) { return rhs < lhs; }
+
+	friend bool operator<=(const small_vector& lhs, const small_vector& rhs) { return !(rhs < lhs); }
+
+	friend bool operator>=(const small_vector& lhs, const small_vector& rhs) { return !(lhs < rhs); }
+
+private:
+	using holder::allocator;
+
+	[[nodiscard]] T* inline_data() noexcept { return reinterpret_cast<T*>(storage_.bytes_); }
+
+	[[nodiscard]] const T* inline_data() const noexcept { return reinterpret_cast<const T*>(storage_.bytes_); }
+
+	[[nodiscard]] size_type grown_capacity(size_type needed) const {
+		if (needed > max_size()) { throw std::length_error{"small_vector exceeds its max_size"}; }
+		return std::max(needed, std::min(capacity_ * 2, max_size()));
+	}
+
+	/// @brief Moves count elements from source into uninitialized dest, leaving source as raw storage. Like
+	/// std::move_if_noexcept, types that can't relocate without the risk of a throwing move are copied instead so
+	/// a failure leaves source intact. Move-only types are moved regardless, a failure then leaves source whole
+	/// but with unspecified values.
+	static void relocate_elements(T* source, size_type count, T* dest) {
+		if constexpr (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+			genesis::uninitialized_relocate_n(source, count, dest);
+		} else if constexpr (std::is_copy_constructible_v<T>) {
+			std::uninitialized_copy_n(source, count, dest);
+			genesis::destroy_n(source, count);
+		} else {
+			std::uninitialized_move_n(source, count, dest);
+			genesis::destroy_n(source, count);
+		}
+	}
+
+	/// @brief Hands the allocation back to the allocator, the elements must already be destroyed or relocated.
+	void release() noexcept {
+		if (!is_inline()) { alloc_traits::deallocate(allocator(), data_, capacity_); }
+		data_ = inline_data();
+		capacity_ = N;
+	}
+
+	void reallocate(size_type new_capacity) {
+		auto* new_data = alloc_traits::allocate(allocator(), new_capacity);
+		try {
+			relocate_elements(data_, size_, new_data);
+		} catch (...) {
+			alloc_traits::deallocate(allocator(), new_data, new_capacity);
+			throw;
+		}
+		adopt(new_data, new_capacity);
+	}
+
+	/// @brief Frees the old allocation, if any, and switches to new_data that already holds the elements.
+	void adopt(T* new_data, size_type new_capacity) noexcept {
+		if (!is_inline()) { alloc_traits::deallocate(allocator(), data_, capacity_); }
+		data_ = new_data;
+		capacity_ = new_capacity;
+	}
+
+	/// @brief Grows the storage and constructs a new element at index. The element is built in the new storage
+	/// before the old elements move, so arguments that refer to them stay valid.
+	template <typename... Args>
+	void grow_and_emplace(size_type index, Args&&... args) {
+		auto new_capacity = grown_capacity(size_ + 1);
+		auto* new_data = alloc_traits::allocate(allocator(), new_capacity);
+		try {
+			genesis::construct_at(new_data + index, std::forward<Args>(args)...);
+		} catch (...) {
+			alloc_traits::deallocate(allocator(), new_data, new_capacity);
+			throw;
+		}
+		try {
+			relocate_elements(data_, index, new_data);
+		} catch (...) {
+			std::destroy_at(new_data + index);
+			alloc_traits::deallocate(allocator(), new_data, new_capacity);
+			throw;
+		}
+		try {
+			relocate_elements(data_ + index, size_ - index, new_data + index + 1);
+		} catch (...) {
+			// The front half already left the old storage, put it back so the vector stays whole.
+			relocate_elements(new_data, index, data_);
+			std::destroy_at(new_data + index);
+			alloc_traits::deallocate(allocator(), new_data, new_capacity);
+			throw;
+		}
+		adopt(new_data, new_capacity);
+		++size_;
+	}
+
+	void append_fill(size_type count, const T& value) {
+		genesis::uninitialized_fill_n(data_ + size_, count, value);
+		size_ += count;
+	}
+
+	/// @brief Takes the elements of other, whose allocator compares equal. A heap buffer is stolen outright,
+	/// inline elements are relocated one by one.
+	void take(small_vector& other) {
+		if (other.is_inline()) {
+			relocate_elements(other.data_, other.size_, inline_data());
+			size_ = std::exchange(other.size_, 0);
+		} else {
+			data_ = std::exchange(other.data_, other.inline_data());
+			size_ = std::exchange(other.size_, 0);
+			capacity_ = std::exchange(other.capacity_, N);
+		}
+	}
+
+	/// @brief Exchanges the elements with other, the allocators are left alone.
+	void swap_storage(small_vector& other) {
+		if (!is_inline() && !other.is_inline()) {
+			std::swap(data_, other.data_);
+			std::swap(size_, other.size_);
+			std::swap(capacity_, other.capacity_);
+			return;
+		}
+		small_vector& inline_side = is_inline() ? *this : other;
+		small_vector& other_side = is_inline() ? other : *this;
+		// Park the inline elements, hand the other side's elements over, then move the parked ones into it.
+		details::small_vector_storage<T, N> parked;
+		auto* parked_data = reinterpret_cast<T*>(parked.bytes_);
+		auto parked_size = std::exchange(inline_side.size_, 0);
+		relocate_elements(inline_side.data_, parked_size, parked_data);
+		inline_side.take(other_side);
+		relocate_elements(parked_data, parked_size, other_side.inline_data());
+		other_side.size_ = parked_size;
+	}
+};
+
+namespace pmr {
+
+/// @brief A small_vector that spills to a std::pmr::memory_resource.
+template <typename T, std::size_t N>
+using small_vector = genesis::small_vector<T, N, std::pmr::polymorphic_allocator<T>>;
+
+} // end namespace pmr
+
+} // end namespace genesis
+
+#endif
@@ -0,0 +1,151 @@
+#if !defined GENESIS_STATIC_OBJECT_POOL_HEADER_INCLUDED
+#define GENESIS_STATIC_OBJECT_POOL_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/inplace_function.hpp"
+#include "genesis/object_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+namespace genesis {
+
+namespace details {
+
+/// @brief The reset hook a static_object_pool uses when none is given, calls T::reset() if T has one.
+template <typename T>
+[[nodiscard]] inplace_function<void(T&)> default_inplace_reset() noexcept {
+	if constexpr (has_reset<T>::value) {
+		return [](T& obj) { obj.reset(); };
+	} else {
+		return {};
+	}
+}
+
+/// @brief Inline storage for the nodes, freelist links, control blocks and callables of a static_object_pool.
+/// A base class of the pool so it exists before the object_pool base that builds the nodes into it.
+template <typename T, std::size_t N, typename Concurrency>
+struct static_pool_storage {
+	using node = pool_node<T, Concurrency>;
+
+	static constexpr std::size_t ring_size = std::is_same_v<Concurrency, pool_spsc> ? N + 1 : 1;
+
+	alignas(node::block_alignment()) std::byte nodes_[node::block_size(N)];
+	std::atomic<uint32_t> links_[N];
+	std::atomic<uint32_t> ring_[ring_size];  // The returns ring of a pool_spsc pool, unused otherwise
+	alignas(std::max_align_t) std::byte control_[N * control_block_size];  // std::shared_ptr control blocks
+	// The object_pool base only holds std::reference_wrapper's to these, which std::function keeps inline.
+	inplace_function<T()> generator_;
+	inplace_function<void(T&)> reset_;
+
+	template <typename Generator, typename Reset>
+	static_pool_storage(Generator&& gen, Reset&& reset) :
+		generator_{std::forward<Generator>(gen)},
+		reset_{std::forward<Reset>(reset)}
+	{ }
+};
+
+} // end namespace details
+
+/// @brief The static_object_pool class is an object_pool of exactly N objects that keeps its nodes and freelist
+/// links inline, so it can live on the stack or in a global and never calls a memory resource. Borrowing and
+/// returning behaves exactly as with object_pool, including the shared_ptr and pool_ptr handles.
+/// Per-thread magazines and growth would need allocations, a static_object_pool has neither. The generator and
+/// reset hook are kept in inplace_function's, so a capture larger than inplace_function_default_capacity is
+/// a compile time error rather than a heap allocation.
+/// @tparam T The type to allocate in the pool
+/// @tparam N The number of objects in the pool
+/// @tparam Concurrency pool_mpmc, pool_spsc or pool_single_thread, see object_pool.
+template <typename T, std::size_t N, typename Concurrency = pool_mpmc>
+class static_object_pool : private details::static_pool_storage<T, N, Concurrency>, public object_pool<T, Concurrency> {
+private:
+	using storage = details::static_pool_storage<T, N, Concurrency>;
+
+	static_assert(N > 0 && N < details::npos_index, "static_object_pool capacity must fit the 32-bit node index space");
+
+	/// @brief The options with everything a static pool can't honour pinned to N objects without magazines.
+	[[nodiscard]] static object_pool_options static_options(object_pool_options opts) noexcept {
+		opts.capacity = N;
+		opts.max_capacity = N;
+		opts.chunk_size = 0;
+		opts.magazine_size = 0;
+		return opts;
+	}
+
+public:
+	using node = typename object_pool<T, Concurrency>::node;
+
+	/// @brief Construct a new static_object_pool object with all objects being constructed with the default
+	/// constructor of type T.
+	static_object_pool() :
+		static_object_pool{object_pool_options{}, []() { return T{}; }}
+	{ }
+
+	/// @brief Construct a new static_object_pool object.
+	/// @tparam Generator Function that returns a object type T.
+	/// @param gen The generator function that must return an object of type T.
+	template <
+		typename Generator,
+		std::enable_if_t<std::is_invocable_r_v<T, Generator>, int> = 0
+	>
+	explicit static_object_pool(Generator gen) :
+		static_object_pool{object_pool_options{}, std::move(gen)}
+	{ }
+
+	/// @brief Construct a new static_object_pool object from a set of options.
+	/// The capacity, maximum capacity, chunk size and magazine size are ignored.
+	/// @tparam Generator Function that returns a object type T.
+	/// @param opts The options for the pool, see object_pool_options.
+	/// @param gen The generator function that must return an object of type T.
+	template <
+		typename Generator,
+		std::enable_if_t<std::is_invocable_r_v<T, Generator>, int> = 0
+	>
+	static_object_pool(const object_pool_options& opts, Generator gen) :
+		static_object_pool{opts, std::move(gen), details::default_inplace_reset<T>()}
+	{ }
+
+	/// @brief Construct a new static_object_pool object from a set of options with a reset hook for the recycle policy.
+	/// The capacity, maximum capacity, chunk size and magazine size are ignored.
+	/// @tparam Generator Function that returns a object type T.
+	/// @tparam Reset Function that takes a T& and puts it back into a reusable state.
+	/// @param opts The options for the pool, see object_pool_options.
+	/// @param gen The generator function that must return an object of type T.
+	/// @param reset The reset hook used by pool_recycle::reset_on_return and pool_recycle::reset_on_borrow.
+	template <
+		typename Generator,
+		typename Reset,
+		std::enable_if_t<std::is_invocable_r_v<T, Generator> && std::is_invocable_v<Reset, T&>, int> = 0
+	>
+	static_object_pool(const object_pool_options& opts, Generator gen, Reset reset) :
+		storage{std::move(gen), std::move(reset)},
+		object_pool<T, Concurrency>{
+			static_options(opts),
+			std::function<T()>{std::ref(storage::generator_)},
+			storage::reset_ ? std::function<void(T&)>{std::ref(storage::reset_)} : std::function<void(T&)>{},
+			std::pmr::null_memory_resource(),
+			storage::nodes_,
+			storage::links_,
+			storage::ring_size > 1 ? storage::ring_ : nullptr,
+			storage::control_
+		}
+	{ }
+
+	static_object_pool(const static_object_pool&) = delete;
+
+	static_object_pool(static_object_pool&&) = delete;
+
+	static_object_pool& operator=(const static_object_pool&) = delete;
+
+	static_object_pool& operator=(static_object_pool&&) = delete;
+};
+
+} // end namespace genesis
+
+#endif
@@ -0,0 +1,339 @@
+#if !defined GENESIS_THREAD_CACHING_RESOURCE_HEADER_INCLUDED
+#define GENESIS_THREAD_CACHING_RESOURCE_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/details/thread_cache.hpp"
+#include "genesis/utility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace genesis {
+
+class thread_caching_resource;
+
+/// @brief Construction options for thread_caching_resource.
+struct thread_caching_resource_options {
+	/// @brief The largest size class in bytes, rounded up to a power of two. Larger allocations, and allocations
+	/// aligned beyond it, go straight to the upstream resource.
+	std::size_t max_small{4096};
+	/// @brief The number of blocks moved between a thread's cache and the shared central list at once.
+	/// A thread caches at most twice this many blocks per size class.
+	std::size_t batch_size{32};
+	/// @brief The number of bytes taken from the upstream resource whenever a size class runs dry.
+	std::size_t span_size{std::size_t{64} << 10};
+};
+
+namespace details {
+
+/// @brief A free block of a size class. Blocks are at least 16 bytes, so they can link both the blocks of a
+/// batch and the batches on the central list.
+struct free_block {
+	free_block* next_;
+	free_block* next_batch_;  // Only meaningful for the first block of a batch on the central list
+};
+
+/// @brief Packs the first block of a batch together with a generation tag into a single 64-bit word, the head of
+/// a central list. The tag is bumped on every successful update of the head, so a batch that was popped and pushed
+/// back in between a load and a compare-exchange no longer compares equal. On 64-bit targets blocks are 16 byte
+/// aligned, so the pointer is kept shifted right by 4 in the low 48 bits, enough for 52-bit addresses, and the
+/// tag wraps in the high 16 bits.
+struct tagged_batch {
+	static constexpr unsigned pointer_bits = sizeof(void*) == 8 ? 48 : 32;
+	static constexpr unsigned pointer_shift = sizeof(void*) == 8 ? 4 : 0;
+
+	free_block* first;
+	uint64_t tag;
+
+	[[nodiscard]] static tagged_batch unpack(uint64_t word) noexcept {
+		auto address = static_cast<std::uintptr_t>((word & ((uint64_t{1} << pointer_bits) - 1)) << pointer_shift);
+		return {reinterpret_cast<free_block*>(address), word >> pointer_bits};
+	}
+
+	[[nodiscard]] uint64_t pack() const noexcept {
+		return tag << pointer_bits | static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(first) >> pointer_shift);
+	}
+
+	/// @brief The word that replaces this head, pointing at new_first with the next generation.
+	[[nodiscard]] uint64_t next(free_block* new_first) const noexcept {
+		return tagged_batch{new_first, tag + 1}.pack();
+	}
+};
+
+/// @brief Memory taken from the upstream resource for a size class, handed back when the resource is destroyed.
+struct resource_span {
+	void* data_;
+	std::size_t size_;
+	std::size_t alignment_;
+};
+
+/// @brief The blocks of one size class cached by one thread.
+struct class_cache {
+	free_block* head_{nullptr};
+	std::size_t count_{0};
+};
+
+/// @brief A thread's caches for a single thread_caching_resource, the owner is cleared by the resource on destruction.
+struct resource_cache {
+	std::atomic<thread_caching_resource*> owner_;
+	std::unique_ptr<class_cache[]> classes_;
+
+	explicit resource_cache(thread_caching_resource* init_owner);
+};
+
+} // end namespace details
+
+/// @brief The thread_caching_resource class is a thread safe std::pmr::memory_resource for small allocations.
+/// Every thread keeps a cache of free blocks per power of two size class and only touches shared state when
+/// a cache runs dry or overflows, moving a whole batch of blocks to or from a lock-free central list per class.
+/// Blocks may be freed by any thread, they go into the freeing thread's cache. Large allocations are passed
+/// to the upstream resource, memory taken for the size classes is only handed back when the resource is destroyed.
+class thread_caching_resource : public std::pmr::memory_resource {
+private:
+	using central_list = cache_padded<std::atomic<uint64_t>>;  // details::tagged_batch
+
+	static constexpr std::size_t min_size = sizeof(details::free_block);
+
+	std::pmr::memory_resource* upstream_;
+	std::size_t max_small_;
+	std::size_t batch_size_;
+	std::size_t span_size_;
+	std::size_t class_count_;
+	std::unique_ptr<central_list[]> central_;  // One lock-free stack of batches per size class
+	std::vector<details::resource_cache*> caches_;  // Guarded by details::thread_cache_mutex()
+	std::mutex spans_mutex_;
+	std::vector<details::resource_span> spans_;  // Guarded by spans_mutex_
+
+public:
+	/// @brief Construct a new thread_caching_resource object.
+	/// @param opts The options for the resource, see thread_caching_resource_options.
+	/// @param upstream The resource the size classes and the large allocations are taken from.
+	explicit thread_caching_resource(
+		const thread_caching_resource_options& opts = {},
+		std::pmr::memory_resource* upstream = std::pmr::get_default_resource()
+	) :
+		upstream_{upstream},
+		max_small_{round_up(std::max(opts.max_small, min_size))},
+		batch_size_{std::max<std::size_t>(opts.batch_size, 1)},
+		span_size_{opts.span_size},
+		class_count_{class_index(max_small_) + 1},
+		central_{std::make_unique<central_list[]>(class_count_)},
+		caches_{},
+		spans_mutex_{},
+		spans_{}
+	{ }
+
+	/// @brief Construct a new thread_caching_resource object with the default options.
+	/// @param upstream The resource the size classes and the large allocations are taken from.
+	explicit thread_caching_resource(std::pmr::memory_resource* upstream) :
+		thread_caching_resource{thread_caching_resource_options{}, upstream}
+	{ }
+
+	thread_caching_resource(const thread_caching_resource&) = delete;
+
+	thread_caching_resource& operator=(const thread_caching_resource&) = delete;
+
+	~thread_caching_resource() override {
+		{
+			std::scoped_lock lock{details::thread_cache_mutex()};
+			for (auto* c : caches_) { c->owner_.store(nullptr, std::memory_order_release); }
+		}
+		for (auto& s : spans_) { upstream_->deallocate(s.data_, s.size_, s.alignment_); }
+	}
+
+	/// @brief Upstream observor for thread_caching_resource.
+	/// @return std::pmr::memory_resource* the resource memory is taken from.
+	[[nodiscard]] std::pmr::memory_resource* upstream_resource() const noexcept { return upstream_; }
+
+	/// @brief Largest size class observor for thread_caching_resource.
+	/// @return std::size_t the largest allocation served from the size classes.
+	[[nodiscard]] std::size_t max_small() const noexcept { return max_small_; }
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		auto k = class_of(bytes, alignment);
+		if (k == class_count_) { return upstream_->allocate(bytes, alignment); }
+		auto* cache = local_cache();
+		if (cache == nullptr) { return allocate_uncached(k); }
+		auto& c = cache->classes_[k];
+		if (c.head_ == nullptr) { refill(c, k); }
+		auto* b = c.head_;
+		c.head_ = b->next_;
+		--c.count_;
+		return b;
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+		auto k = class_of(bytes, alignment);
+		if (k == class_count_) {
+			upstream_->deallocate(p, bytes, alignment);
+			return;
+		}
+		auto* b = static_cast<details::free_block*>(p);
+		auto* cache = local_cache();
+		if (cache == nullptr) {
+			b->next_ = nullptr;
+			push_batch(k, b);
+			return;
+		}
+		auto& c = cache->classes_[k];
+		b->next_ = c.head_;
+		c.head_ = b;
+		if (++c.count_ > 2 * batch_size_) { spill(c, k, batch_size_); }
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	/// @brief The smallest power of two at or above size, clamped to the largest power of two a std::size_t holds.
+	[[nodiscard]] static std::size_t round_up(std::size_t size) noexcept {
+		constexpr std::size_t largest = std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 1);
+		if (size >= largest) { return largest; }
+		std::size_t rounded = min_size;
+		while (rounded < size) { rounded <<= 1; }
+		return rounded;
+	}
+
+	/// @brief The size class serving a request, class_count_ if it is passed to the upstream resource.
+	[[nodiscard]] std::size_t class_of(std::size_t bytes, std::size_t alignment) const noexcept {
+		auto wanted = std::max(bytes, alignment);
+		return wanted > max_small_ ? class_count_ : class_index(wanted);
+	}
+
+	[[nodiscard]] static std::size_t class_index(std::size_t size) noexcept {
+		std::size_t k = 0;
+		for (auto s = min_size; s < size; s <<= 1) { ++k; }
+		return k;
+	}
+
+	details::resource_cache* local_cache() noexcept {
+		try {
+			return details::thread_cache_depot<thread_caching_resource, details::resource_cache>::local(this);
+		} catch (...) {
+			// Failing to create a cache only costs the fast path.
+			return nullptr;
+		}
+	}
+
+	/// @brief Refills an empty cache with a batch from the central list, or with a new span if there is none.
+	void refill(details::class_cache& c, std::size_t k) {
+		auto* batch = pop_batch(k);
+		if (batch == nullptr) {
+			batch = carve(k);
+		}
+		std::size_t count = 0;
+		for (auto* b = batch; b != nullptr; b = b->next_) { ++count; }
+		c.head_ = batch;
+		c.count_ = count;
+		while (c.count_ > 2 * batch_size_) { spill(c, k, batch_size_); }
+	}
+
+	/// @brief Moves count blocks from the front of the cache to the central list as one batch.
+	void spill(details::class_cache& c, std::size_t k, std::size_t count) noexcept {
+		if (c.head_ == nullptr) { return; }
+		auto* first = c.head_;
+		auto* last = first;
+		std::size_t moved = 1;
+		for (; moved < count && last->next_ != nullptr; ++moved) { last = last->next_; }
+		c.head_ = last->next_;
+		c.count_ -= moved;
+		last->next_ = nullptr;
+		push_batch(k, first);
+	}
+
+	void* allocate_uncached(std::size_t k) {
+		auto* batch = pop_batch(k);
+		if (batch == nullptr) { batch = carve(k); }
+		if (auto* rest = batch->next_; rest != nullptr) { push_batch(k, rest); }
+		return batch;
+	}
+
+	/// @brief Takes a span from the upstream resource and links its blocks into a list.
+	details::free_block* carve(std::size_t k) {
+		auto size = min_size << k;
+		auto span = std::max(span_size_, size * batch_size_);
+		// Aligning the span to the class size aligns every block to its size, which covers any alignment that
+		// was rounded into the class.
+		auto* bytes = static_cast<std::byte*>(upstream_->allocate(span, size));
+		try {
+			std::scoped_lock lock{spans_mutex_};
+			spans_.push_back({bytes, span, size});
+		} catch (...) {
+			upstream_->deallocate(bytes, span, size);
+			throw;
+		}
+		details::free_block* head = nullptr;
+		for (auto n = span / size; n > 0; --n) {
+			auto* b = reinterpret_cast<details::free_block*>(bytes + (n - 1) * size);
+			b->next_ = head;
+			head = b;
+		}
+		return head;
+	}
+
+	void push_batch(std::size_t k, details::free_block* first) noexcept {
+		auto& central = *central_[k];
+		auto word = central.load(std::memory_order_relaxed);
+		details::tagged_batch head{};
+		do {
+			head = details::tagged_batch::unpack(word);
+			first->next_batch_ = head.first;
+		} while (!central.compare_exchange_weak(word, head.next(first), std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	/// @brief Takes one batch off the central list with a single compare-exchange on its tagged head.
+	[[nodiscard]] details::free_block* pop_batch(std::size_t k) noexcept {
+		auto& central = *central_[k];
+		auto word = central.load(std::memory_order_acquire);
+		while (true) {
+			auto head = details::tagged_batch::unpack(word);
+			if (head.first == nullptr) { return nullptr; }
+			// Spans stay mapped until the resource is destroyed, so the link is always readable. If another thread
+			// took the batch in the meantime the link may already be overwritten, but then the tag has moved on,
+			// the exchange fails and the value read is discarded.
+			auto* next = head.first->next_batch_;
+			if (central.compare_exchange_weak(word, head.next(next), std::memory_order_acquire, std::memory_order_acquire)) {
+				return head.first;
+			}
+		}
+	}
+
+	void attach_cache(details::resource_cache& cache) {
+		std::scoped_lock lock{details::thread_cache_mutex()};
+		caches_.push_back(&cache);
+	}
+
+	/// @brief Returns every block cached by a thread, the caller must hold details::thread_cache_mutex().
+	void detach_cache(details::resource_cache& cache) noexcept {
+		for (std::size_t k = 0; k < class_count_; ++k) {
+			auto& c = cache.classes_[k];
+			if (c.head_ != nullptr) { push_batch(k, c.head_); }
+			c = {};
+		}
+		cache.owner_.store(nullptr, std::memory_order_release);
+		caches_.erase(std::remove(caches_.begin(), caches_.end(), &cache), caches_.end());
+	}
+
+	friend class details::thread_cache_depot<thread_caching_resource, details::resource_cache>;
+	friend struct details::resource_cache;
+};
+
+namespace details {
+
+inline resource_cache::resource_cache(thread_caching_resource* init_owner) :
+	owner_{init_owner},
+	classes_{std::make_unique<class_cache[]>(init_owner->class_count_)}
+{ }
+
+} // end namespace details
+
+} // end namespace genesis
+
+#endif
@@ -2,8 +2,12 @@
 #define GENESIS_UTILITY_HEADER_INCLUDED
 #pragma once
 
+#include "genesis/config.hpp"
+
+#include <cstddef>
 #include <initializer_list>
 #include <type_traits>
+#include <utility>
 
 namespace genesis{ 
 
@@ -35,6 +39,36 @@ inline constexpr std::size_t max(std::initializer_list<std::size_t> il) noexcept
 	return max;
 }
 
+/// @brief Minimum distance between two objects written by different threads to avoid false sharing,
+/// like C++17's std::hardware_destructive_interference_size but fixed per architecture, see GENESIS_CACHELINE_SIZE.
+inline constexpr std::size_t hardware_destructive_interference_size = GENESIS_CACHELINE_SIZE;
+
+/// @brief Maximum size of contiguous memory that is guaranteed to share a cache line.
+inline constexpr std::size_t hardware_constructive_interference_size = GENESIS_CACHELINE_SIZE;
+
+/// @brief Wraps a T on a cache line of its own, so writes to it don't slow down threads touching its neighbours.
+/// @tparam T The type to isolate, usually a contended std::atomic.
+template <typename T>
+struct alignas(hardware_destructive_interference_size) cache_padded {
+	T value;
+
+	template <
+		typename... Args,
+		std::enable_if_t<std::is_constructible_v<T, Args...>, int> = 0
+	>
+	constexpr explicit cache_padded(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) :
+		value(std::forward<Args>(args)...)
+	{ }
+
+	constexpr T& operator*() noexcept { return value; }
+
+	constexpr const T& operator*() const noexcept { return value; }
+
+	constexpr T* operator->() noexcept { return &value; }
+
+	constexpr const T* operator->() const noexcept { return &value; }
+};
+
 template <typename T, typename... Ts>
 inline constexpr std::size_t index_of() noexcept {
 	constexpr bool same[] {std::is_same_v<T, Ts>...};
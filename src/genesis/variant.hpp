@@ -0,0 +1,663 @@
+#if !defined GENESIS_VARIANT_HEADER_INCLUDED
+#define GENESIS_VARIANT_HEADER_INCLUDED
+#pragma once
+
+#include "genesis/config.hpp"
+#include "genesis/memory.hpp"
+#include "genesis/type_traits.hpp"
+#include "genesis/utility.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace genesis {
+
+template <typename... Ts>
+class variant;
+
+/// @brief The number of alternatives of a variant.
+template <typename Variant>
+struct variant_size;
+
+template <typename... Ts>
+struct variant_size<variant<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> {};
+
+template <typename Variant>
+struct variant_size<const Variant> : variant_size<Variant> {};
+
+template <typename Variant>
+inline constexpr std::size_t variant_size_v = variant_size<Variant>::value;
+
+/// @brief The type of the alternative at index I of a variant.
+template <std::size_t I, typename Variant>
+struct variant_alternative;
+
+template <std::size_t I, typename... Ts>
+struct variant_alternative<I, variant<Ts...>> {
+	static_assert(I < sizeof...(Ts), "variant_alternative index out of range");
+	using type = std::tuple_element_t<I, std::tuple<Ts...>>;
+};
+
+template <std::size_t I, typename Variant>
+struct variant_alternative<I, const Variant> {
+	using type = const typename variant_alternative<I, Variant>::type;
+};
+
+template <std::size_t I, typename Variant>
+using variant_alternative_t = typename variant_alternative<I, Variant>::type;
+
+/// @brief The index of a variant that holds no value.
+inline constexpr std::size_t variant_npos = static_cast<std::size_t>(-1);
+
+namespace details {
+
+/// @brief The smallest unsigned type that can hold every index of N alternatives plus the valueless marker.
+template <std::size_t N>
+using variant_index_t = std::conditional_t<
+	(N < std::numeric_limits<uint8_t>::max()), uint8_t,
+	std::conditional_t<(N < std::numeric_limits<uint16_t>::max()), uint16_t, uint32_t>
+>;
+
+template <typename T, typename... Ts>
+inline constexpr std::size_t count_of_v = (std::size_t{0} + ... + std::size_t{std::is_same_v<T, Ts>});
+
+/// @brief A variant of trivially copyable alternatives builds a new value aside before replacing the old one, so it
+/// can never become valueless and visit needs no check for it.
+template <typename... Ts>
+inline constexpr bool variant_never_valueless_v = ((std::is_trivially_copyable_v<Ts> && std::is_nothrow_move_constructible_v<Ts>) && ...);
+
+template <typename T>
+using variant_array_of_one = T[1];
+
+/// @brief Whether an alternative T may be converted to from a U, following P0608: T x[] = {std::forward<U>(u)}
+/// must be well-formed, which rules out narrowing conversions, and a bool alternative only accepts a bool.
+template <typename T, typename U, typename = void>
+struct variant_accepts : std::false_type {};
+
+template <typename T, typename U>
+struct variant_accepts<T, U, std::void_t<decltype(variant_array_of_one<T>{std::declval<U>()})>> :
+	std::bool_constant<!std::is_same_v<std::remove_cv_t<T>, bool> || std::is_same_v<remove_cvref_t<U>, bool>> {};
+
+/// @brief Parameter of the overload standing in for an alternative that doesn't accept the argument, never matches.
+template <std::size_t I>
+struct variant_no_overload {};
+
+/// @brief One overload per alternative that accepts a U, overload resolution on the argument picks the alternative
+/// to construct, as the converting constructor of std::variant does.
+template <std::size_t I, typename T, typename U, bool = variant_accepts<T, U>::value>
+struct variant_overload {
+	static std::integral_constant<std::size_t, I> select(T);
+};
+
+template <std::size_t I, typename T, typename U>
+struct variant_overload<I, T, U, false> {
+	static void select(variant_no_overload<I>);
+};
+
+template <typename Indices, typename U, typename... Ts>
+struct variant_overloads;
+
+template <std::size_t... Is, typename U, typename... Ts>
+struct variant_overloads<std::index_sequence<Is...>, U, Ts...> : variant_overload<Is, Ts, U>... {
+	using variant_overload<Is, Ts, U>::select...;
+};
+
+template <typename U, typename... Ts>
+using variant_selected_t = decltype(variant_overloads<std::index_sequence_for<Ts...>, U, Ts...>::select(std::declval<U>()));
+
+template <typename U, typename Enable, typename... Ts>
+struct variant_selection : std::integral_constant<std::size_t, variant_npos> {};
+
+template <typename U, typename... Ts>
+struct variant_selection<U, std::void_t<variant_selected_t<U, Ts...>>, Ts...> : variant_selected_t<U, Ts...> {};
+
+template <typename U, typename... Ts>
+inline constexpr std::size_t variant_selection_v = variant_selection<U, void, Ts...>::value;
+
+template <typename T>
+struct is_in_place_tag : std::false_type {};
+
+template <typename T>
+struct is_in_place_tag<std::in_place_type_t<T>> : std::true_type {};
+
+template <std::size_t I>
+struct is_in_place_tag<std::in_place_index_t<I>> : std::true_type {};
+
+/// @brief Raw storage for the alternatives and the index of the active one.
+template <typename... Ts>
+struct variant_data {
+	using index_type = variant_index_t<sizeof...(Ts)>;
+
+	static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+	alignas(Ts...) std::byte storage_[genesis::max({sizeof(Ts)...})];
+	index_type index_;
+
+	template <std::size_t I>
+	[[nodiscard]] auto* get_ptr() noexcept {
+		using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+		return std::launder(reinterpret_cast<T*>(storage_));
+	}
+
+	template <std::size_t I>
+	[[nodiscard]] const auto* get_ptr() const noexcept {
+		using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+		return std::launder(reinterpret_cast<const T*>(storage_));
+	}
+
+	template <std::size_t I, typename... Args>
+	auto& construct(Args&&... args) {
+		using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+		auto* p = genesis::construct_at(reinterpret_cast<T*>(storage_), std::forward<Args>(args)...);
+		index_ = static_cast<index_type>(I);
+		return *p;
+	}
+
+	void destroy() noexcept;
+};
+
+/// @brief Calls f with std::integral_constant<std::size_t, I> for the runtime index, through a switch the
+/// compiler turns into a jump table with the cases inlined for up to 16 alternatives, and through a flat table of
+/// function pointers beyond that.
+template <std::size_t N, typename F>
+decltype(auto) dispatch_index(std::size_t index, F&& f);
+
+template <typename F, std::size_t I>
+decltype(auto) dispatch_one(F& f) {
+	return f(std::integral_constant<std::size_t, I>{});
+}
+
+template <std::size_t N, typename F, std::size_t... Is>
+decltype(auto) dispatch_table(std::size_t index, F& f, std::index_sequence<Is...>) {
+	using result = decltype(f(std::integral_constant<std::size_t, 0>{}));
+	static constexpr result (*table[])(F&) = {&dispatch_one<F, Is>...};
+	return table[index](f);
+}
+
+#define GENESIS_VARIANT_CASE(I)                                                       \
+	case I:                                                                           \
+		if constexpr (I < N) { return f(std::integral_constant<std::size_t, I>{}); } \
+		[[fallthrough]]
+
+template <std::size_t N, typename F>
+decltype(auto) dispatch_index(std::size_t index, F&& f) {
+	if constexpr (N <= 16) {
+		switch (index) {
+			GENESIS_VARIANT_CASE(0);
+			GENESIS_VARIANT_CASE(1);
+			GENESIS_VARIANT_CASE(2);
+			GENESIS_VARIANT_CASE(3);
+			GENESIS_VARIANT_CASE(4);
+			GENESIS_VARIANT_CASE(5);
+			GENESIS_VARIANT_CASE(6);
+			GENESIS_VARIANT_CASE(7);
+			GENESIS_VARIANT_CASE(8);
+			GENESIS_VARIANT_CASE(9);
+			GENESIS_VARIANT_CASE(10);
+			GENESIS_VARIANT_CASE(11);
+			GENESIS_VARIANT_CASE(12);
+			GENESIS_VARIANT_CASE(13);
+			GENESIS_VARIANT_CASE(14);
+			GENESIS_VARIANT_CASE(15);
+			default:
+				// Callers check the index first, every valid index has returned above.
+#if GENESIS_VENDOR_GNU || GENESIS_VENDOR_CLANG
+				__builtin_unreachable();
+#elif GENESIS_VENDOR_MSVC
+				__assume(0);
+#endif
+				return f(std::integral_constant<std::size_t, 0>{});
+		}
+	} else {
+		return dispatch_table<N>(index, f, std::make_index_sequence<N>{});
+	}
+}
+
+#undef GENESIS_VARIANT_CASE
+
+template <typename... Ts>
+void variant_data<Ts...>::destroy() noexcept {
+	if constexpr (!(std::is_trivially_destructible_v<Ts> && ...)) {
+		if (index_ != npos) {
+			dispatch_index<sizeof...(Ts)>(index_, [this](auto i) { std::destroy_at(get_ptr<decltype(i)::value>()); });
+		}
+	}
+	index_ = npos;
+}
+
+/// @brief Adds the destructor when some alternative needs one, the variant stays trivially destructible otherwise.
+template <bool TriviallyDestructible, typename... Ts>
+struct variant_destructor : variant_data<Ts...> {};
+
+template <typename... Ts>
+struct variant_destructor<false, Ts...> : variant_data<Ts...> {
+	variant_destructor() = default;
+	variant_destructor(const variant_destructor&) = default;
+	variant_destructor(variant_destructor&&) = default;
+	variant_destructor& operator=(const variant_destructor&) = default;
+	variant_destructor& operator=(variant_destructor&&) = default;
+	~variant_destructor() { this->destroy(); }
+};
+
+template <typename... Ts>
+using variant_destructor_base = variant_destructor<(std::is_trivially_destructible_v<Ts> && ...), Ts...>;
+
+/// @brief Copy and move by alternative. When every alternative is trivially copyable the defaulted members copy
+/// the storage and index bytes as they are, which keeps the variant itself trivially copyable.
+template <bool TriviallyCopyable, typename... Ts>
+struct variant_copy_move : variant_destructor_base<Ts...> {};
+
+template <typename... Ts>
+struct variant_copy_move<false, Ts...> : variant_destructor_base<Ts...> {
+	variant_copy_move() = default;
+
+	variant_copy_move(const variant_copy_move& other) noexcept((std::is_nothrow_copy_constructible_v<Ts> && ...)) {
+		this->index_ = this->npos;
+		if (other.index_ != other.npos) {
+			dispatch_index<sizeof...(Ts)>(other.index_, [this, &other](auto i) {
+				this->template construct<decltype(i)::value>(*other.template get_ptr<decltype(i)::value>());
+			});
+		}
+	}
+
+	variant_copy_move(variant_copy_move&& other) noexcept((std::is_nothrow_move_constructible_v<Ts> && ...)) {
+		this->index_ = this->npos;
+		if (other.index_ != other.npos) {
+			dispatch_index<sizeof...(Ts)>(other.index_, [this, &other](auto i) {
+				this->template construct<decltype(i)::value>(std::move(*other.template get_ptr<decltype(i)::value>()));
+			});
+		}
+	}
+
+	variant_copy_move& operator=(const variant_copy_move& other) noexcept(
+		(std::is_nothrow_copy_constructible_v<Ts> && ...) && (std::is_nothrow_copy_assignable_v<Ts> && ...)
+	) {
+		if (this == &other) { return *this; }
+		if (other.index_ == other.npos) {
+			this->destroy();
+		} else if (this->index_ == other.index_) {
+			dispatch_index<sizeof...(Ts)>(other.index_, [this, &other](auto i) {
+				*this->template get_ptr<decltype(i)::value>() = *other.template get_ptr<decltype(i)::value>();
+			});
+		} else {
+			// Left valueless if the copy throws.
+			this->destroy();
+			dispatch_index<sizeof...(Ts)>(other.index_, [this, &other](auto i) {
+				this->template construct<decltype(i)::value>(*other.template get_ptr<decltype(i)::value>());
+			});
+		}
+		return *this;
+	}
+
+	variant_copy_move& operator=(variant_copy_move&& other) noexcept(
+		(std::is_nothrow_move_constructible_v<Ts> && ...) && (std::is_nothrow_move_assignable_v<Ts> && ...)
+	) {
+		if (this == &other) { return *this; }
+		if (other.index_ == other.npos) {
+			this->destroy();
+		} else if (this->index_ == other.index_) {
+			dispatch_index<sizeof...(Ts)>(other.index_, [this, &other](auto i) {
+				*this->template get_ptr<decltype(i)::value>() = std::move(*other.template get_ptr<decltype(i)::value>());
+			});
+		} else {
+			this->destroy();
+			dispatch_index<sizeof...(Ts)>(other.index_, [this, &other](auto i) {
+				this->template construct<decltype(i)::value>(std::move(*other.template get_ptr<decltype(i)::value>()));
+			});
+		}
+		return *this;
+	}
+};
+
+template <typename... Ts>
+using variant_copy_move_base = variant_copy_move<(std::is_trivially_copyable_v<Ts> && ...), Ts...>;
+
+/// @brief Mixins that delete the copy and move members some alternative doesn't support, the defaulted members of
+/// variant follow them.
+template <bool Enable>
+struct enable_copy {};
+
+template <>
+struct enable_copy<false> {
+	enable_copy() = default;
+	enable_copy(const enable_copy&) = delete;
+	enable_copy(enable_copy&&) = default;
+	enable_copy& operator=(const enable_copy&) = default;
+	enable_copy& operator=(enable_copy&&) = default;
+};
+
+template <bool Enable>
+struct enable_copy_assign {};
+
+template <>
+struct enable_copy_assign<false> {
+	enable_copy_assign() = default;
+	enable_copy_assign(const enable_copy_assign&) = default;
+	enable_copy_assign(enable_copy_assign&&) = default;
+	enable_copy_assign& operator=(const enable_copy_assign&) = delete;
+	enable_copy_assign& operator=(enable_copy_assign&&) = default;
+};
+
+template <bool EnableConstruct, bool EnableAssign>
+struct enable_move {};
+
+template <bool EnableAssign>
+struct enable_move<false, EnableAssign> {
+	enable_move() = default;
+	enable_move(const enable_move&) = default;
+	enable_move(enable_move&&) = delete;
+	enable_move& operator=(const enable_move&) = default;
+	enable_move& operator=(enable_move&&) = default;
+};
+
+template <>
+struct enable_move<true, false> {
+	enable_move() = default;
+	enable_move(const enable_move&) = default;
+	enable_move(enable_move&&) = default;
+	enable_move& operator=(const enable_move&) = default;
+	enable_move& operator=(enable_move&&) = delete;
+};
+
+/// @brief Reaches the storage of a variant for the free functions.
+struct variant_access {
+	template <std::size_t I, typename Variant>
+	[[nodiscard]] static auto* get(Variant& v) noexcept { return v.template get_ptr<I>(); }
+
+	/// @brief Calls vis with the active alternative of v, throws std::bad_variant_access if it is valueless.
+	template <typename Visitor, typename Variant>
+	static decltype(auto) visit(Visitor&& vis, Variant&& v) {
+		constexpr auto size = variant_size_v<remove_cvref_t<Variant>>;
+		if (v.valueless_by_exception()) { throw std::bad_variant_access{}; }
+		return dispatch_index<size>(v.index(), [&vis, &v](auto i) -> decltype(auto) {
+			if constexpr (std::is_lvalue_reference_v<Variant>) {
+				return std::invoke(std::forward<Visitor>(vis), *get<decltype(i)::value>(v));
+			} else {
+				return std::invoke(std::forward<Visitor>(vis), std::move(*get<decltype(i)::value>(v)));
+			}
+		});
+	}
+};
+
+} // end namespace details
+
+/// @brief The variant class is a type safe union of Ts, a lighter std::variant for hot dispatch loops. The index
+/// is the smallest unsigned type that fits, a single byte for up to 254 alternatives, and a variant of trivially
+/// copyable alternatives is itself trivially copyable. visit dispatches through a switch for up to 16 alternatives
+/// and a flat function table beyond, either way a single jump. Becomes valueless if an alternative's constructor
+/// throws during emplace or assignment, unless every alternative is trivially copyable.
+/// @tparam Ts The alternatives, distinct object types.
+template <typename... Ts>
+class variant :
+	private details::variant_copy_move_base<Ts...>,
+	private details::enable_copy<(std::is_copy_constructible_v<Ts> && ...)>,
+	private details::enable_copy_assign<((std::is_copy_constructible_v<Ts> && std::is_copy_assignable_v<Ts>) && ...)>,
+	private details::enable_move<
+		(std::is_move_constructible_v<Ts> && ...),
+		((std::is_move_constructible_v<Ts> && std::is_move_assignable_v<Ts>) && ...)
+	>
+{
+private:
+	using base = details::variant_copy_move_base<Ts...>;
+
+	static_assert(sizeof...(Ts) > 0, "variant needs at least one alternative");
+	static_assert(((std::is_object_v<Ts> && !std::is_array_v<Ts>) && ...), "variant alternatives must be non array object types");
+
+	template <std::size_t I>
+	using alternative = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+	template <typename U>
+	static constexpr std::size_t selection = details::variant_selection_v<U, Ts...>;
+
+	friend struct details::variant_access;
+
+public:
+	using index_type = details::variant_index_t<sizeof...(Ts)>;
+
+	/// @brief Construct a new variant object holding a value initialized first alternative.
+	template <
+		typename T0 = alternative<0>,
+		std::enable_if_t<std::is_default_constructible_v<T0>, int> = 0
+	>
+	variant() noexcept(std::is_nothrow_default_constructible_v<T0>) {
+		this->template construct<0>();
+	}
+
+	variant(const variant&) = default;
+
+	variant(variant&&) = default;
+
+	/// @brief Construct a new variant object holding the alternative that overload resolution picks for u.
+	template <
+		typename U,
+		std::enable_if_t<
+			!std::is_same_v<remove_cvref_t<U>, variant> &&
+			!details::is_in_place_tag<remove_cvref_t<U>>::value &&
+			selection<U&&> != variant_npos,
+			int
+		> = 0
+	>
+	variant(U&& u) noexcept(std::is_nothrow_constructible_v<alternative<selection<U&&>>, U>) {
+		this->template construct<selection<U&&>>(std::forward<U>(u));
+	}
+
+	template <
+		typename T,
+		typename... Args,
+		std::enable_if_t<details::count_of_v<T, Ts...> == 1 && std::is_constructible_v<T, Args...>, int> = 0
+	>
+	explicit variant(std::in_place_type_t<T>, Args&&... args) {
+		this->template construct<index_of<T, Ts...>()>(std::forward<Args>(args)...);
+	}
+
+	template <
+		std::size_t I,
+		typename... Args,
+		std::enable_if_t<(I < sizeof...(Ts)), int> = 0
+	>
+	explicit variant(std::in_place_index_t<I>, Args&&... args) {
+		this->template construct<I>(std::forward<Args>(args)...);
+	}
+
+	~variant() = default;
+
+	variant& operator=(const variant&) = default;
+
+	variant& operator=(variant&&) = default;
+
+	/// @brief Assigns to the alternative that overload resolution picks for u, constructing it if another is active.
+	template <
+		typename U,
+		std::enable_if_t<!std::is_same_v<remove_cvref_t<U>, variant> && selection<U&&> != variant_npos, int> = 0
+	>
+	variant& operator=(U&& u) {
+		constexpr auto I = selection<U&&>;
+		if (this->index_ == I) {
+			*this->template get_ptr<I>() = std::forward<U>(u);
+		} else {
+			emplace<I>(std::forward<U>(u));
+		}
+		return *this;
+	}
+
+	/// @brief Index of the active alternative.
+	/// @return std::size_t variant_npos if valueless.
+	[[nodiscard]] constexpr std::size_t index() const noexcept {
+		return valueless_by_exception() ? variant_npos : static_cast<std::size_t>(this->index_);
+	}
+
+	[[nodiscard]] constexpr bool valueless_by_exception() const noexcept {
+		if constexpr (details::variant_never_valueless_v<Ts...>) {
+			return false;
+		} else {
+			return this->index_ == base::npos;
+		}
+	}
+
+	template <typename T, typename... Args, std::enable_if_t<details::count_of_v<T, Ts...> == 1, int> = 0>
+	T& emplace(Args&&... args) {
+		return emplace<index_of<T, Ts...>()>(std::forward<Args>(args)...);
+	}
+
+	template <std::size_t I, typename... Args>
+	alternative<I>& emplace(Args&&... args) {
+		static_assert(I < sizeof...(Ts), "variant::emplace index out of range");
+		if constexpr (details::variant_never_valueless_v<Ts...>) {
+			alternative<I> value(std::forward<Args>(args)...);
+			return this->template construct<I>(std::move(value));
+		} else {
+			this->destroy();
+			return this->template construct<I>(std::forward<Args>(args)...);
+		}
+	}
+
+	void swap(variant& other) noexcept(
+		((std::is_nothrow_move_constructible_v<Ts> && std::is_nothrow_swappable_v<Ts>) && ...)
+	) {
+		if (this->index_ == other.index_) {
+			if (this->index_ != base::npos) {
+				details::dispatch_index<sizeof...(Ts)>(this->index_, [this, &other](auto i) {
+					using std::swap;
+					swap(*this->template get_ptr<decltype(i)::value>(), *other.template get_ptr<decltype(i)::value>());
+				});
+			}
+		} else {
+			variant tmp{std::move(other)};
+			other = std::move(*this);
+			*this = std::move(tmp);
+		}
+	}
+
+	/// @brief Calls vis with the active alternative.
+	/// @return decltype(auto) whatever vis returns, the same type for every alternative.
+	template <typename Visitor>
+	decltype(auto) visit(Visitor&& vis) & { return details::variant_access::visit(std::forward<Visitor>(vis), *this); }
+
+	template <typename Visitor>
+	decltype(auto) visit(Visitor&& vis) const & { return details::variant_access::visit(std::forward<Visitor>(vis), *this); }
+
+	template <typename Visitor>
+	decltype(auto) visit(Visitor&& vis) && { return details::variant_access::visit(std::forward<Visitor>(vis), std::move(*this)); }
+};
+
+template <typename T, typename... Ts>
+[[nodiscard]] constexpr bool holds_alternative(const variant<Ts...>& v) noexcept {
+	static_assert(details::count_of_v<T, Ts...> == 1, "holds_alternative type must appear exactly once");
+	return v.index() == index_of<T, Ts...>();
+}
+
+template <std::size_t I, typename... Ts>
+[[nodiscard]] constexpr auto* get_if(variant<Ts...>* v) noexcept {
+	static_assert(I < sizeof...(Ts), "get_if index out of range");
+	return v != nullptr && v->index() == I ? details::variant_access::get<I>(*v) : nullptr;
+}
+
+template <std::size_t I, typename... Ts>
+[[nodiscard]] constexpr const auto* get_if(const variant<Ts...>* v) noexcept {
+	static_assert(I < sizeof...(Ts), "get_if index out of range");
+	return v != nullptr && v->index() == I ? details::variant_access::get<I>(*v) : nullptr;
+}
+
+template <typename T, typename... Ts>
+[[nodiscard]] constexpr T* get_if(variant<Ts...>* v) noexcept {
+	static_assert(details::count_of_v<T, Ts...> == 1, "get_if type must appear exactly once");
+	return get_if<index_of<T, Ts...>()>(v);
+}
+
+template <typename T, typename... Ts>
+[[nodiscard]] constexpr const T* get_if(const variant<Ts...>* v) noexcept {
+	static_assert(details::count_of_v<T, Ts...> == 1, "get_if type must appear exactly once");
+	return get_if<index_of<T, Ts...>()>(v);
+}
+
+template <std::size_t I, typename... Ts>
+[[nodiscard]] constexpr variant_alternative_t<I, variant<Ts...>>& get(variant<Ts...>& v) {
+	if (auto* p = get_if<I>(&v); p != nullptr) { return *p; }
+	throw std::bad_variant_access{};
+}
+
+template <std::size_t I, typename... Ts>
+[[nodiscard]] constexpr const variant_alternative_t<I, variant<Ts...>>& get(const variant<Ts...>& v) {
+	if (auto* p = get_if<I>(&v); p != nullptr) { return *p; }
+	throw std::bad_variant_access{};
+}
+
+template <std::size_t I, typename... Ts>
+[[nodiscard]] constexpr variant_alternative_t<I, variant<Ts...>>&& get(variant<Ts...>&& v) {
+	return std::move(get<I>(v));
+}
+
+template <typename T, typename... Ts>
+[[nodiscard]] constexpr T& get(variant<Ts...>& v) { return get<index_of<T, Ts...>()>(v); }
+
+template <typename T, typename... Ts>
+[[nodiscard]] constexpr const T& get(const variant<Ts...>& v) { return get<index_of<T, Ts...>()>(v); }
+
+template <typename T, typename... Ts>
+[[nodiscard]] constexpr T&& get(variant<Ts...>&& v) { return std::move(get<index_of<T, Ts...>()>(v)); }
+
+/// @brief Calls vis with the active alternatives of the variants.
+/// @return decltype(auto) whatever vis returns, the same type for every combination of alternatives.
+template <typename Visitor, typename Variant>
+decltype(auto) visit(Visitor&& vis, Variant&& v) {
+	return details::variant_access::visit(std::forward<Visitor>(vis), std::forward<Variant>(v));
+}
+
+template <typename Visitor, typename Variant, typename... Variants, std::enable_if_t<(sizeof...(Variants) > 0), int> = 0>
+decltype(auto) visit(Visitor&& vis, Variant&& v, Variants&&... rest) {
+	// Peel one variant per level, each level is a single jump.
+	return details::variant_access::visit([&vis, &rest...](auto&& first) -> decltype(auto) {
+		return genesis::visit(
+			[&vis, &first](auto&&... others) -> decltype(auto) {
+				return std::invoke(std::forward<Visitor>(vis), std::forward<decltype(first)>(first), std::forward<decltype(others)>(others)...);
+			},
+			std::forward<Variants>(rest)...
+		);
+	}, std::forward<Variant>(v));
+}
+
+template <typename... Ts>
+[[nodiscard]] bool operator==(const variant<Ts...>& lhs, const variant<Ts...>& rhs) {
+	if (lhs.index() != rhs.index()) { return false; }
+	if (lhs.valueless_by_exception()) { return true; }
+	return details::dispatch_index<sizeof...(Ts)>(lhs.index(), [&lhs, &rhs](auto i) -> bool {
+		return *get_if<decltype(i)::value>(&lhs) == *get_if<decltype(i)::value>(&rhs);
+	});
+}
+
+template <typename... Ts>
+[[nodiscard]] bool operator!=(const variant<Ts...>& lhs, const variant<Ts...>& rhs) { return !(lhs == rhs); }
+
+template <typename... Ts>
+[[nodiscard]] bool operator<(const variant<Ts...>& lhs, const variant<Ts...>& rhs) {
+	if (rhs.valueless_by_exception()) { return false; }
+	if (lhs.valueless_by_exception()) { return true; }
+	if (lhs.index() != rhs.index()) { return lhs.index() < rhs.index(); }
+	return details::dispatch_index<sizeof...(Ts)>(lhs.index(), [&lhs, &rhs](auto i) -> bool {
+		return *get_if<decltype(i)::value>(&lhs) < *get_if<decltype(i)::value>(&rhs);
+	});
+}
+
+template <typename... Ts>
+[[nodiscard]] bool operator>(const variant<Ts...>& lhs, const variant<Ts...>& rhs) { return rhs < lhs; }
+
+template <typename... Ts>
+[[nodiscard]] bool operator<=(const variant<Ts...>& lhs, const variant<Ts...>& rhs) { return !(rhs < lhs); }
+
+template <typename... Ts>
+[[nodiscard]] bool operator>=(const variant<Ts...>& lhs, const variant<Ts...>& rhs) { return !(lhs < rhs); }
+
+template <typename... Ts>
+void swap(variant<Ts...>& lhs, variant<Ts...>& rhs) noexcept(noexcept(lhs.swap(rhs))) { lhs.swap(rhs); }
+
+} // end namespace genesis
+
+#endif
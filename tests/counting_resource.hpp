@@ -0,0 +1,38 @@
+#if !defined GENESIS_TESTS_COUNTING_RESOURCE_HEADER_INCLUDED
+#define GENESIS_TESTS_COUNTING_RESOURCE_HEADER_INCLUDED
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+namespace genesis::tests {
+
+/// @brief Memory resource that forwards to the default resource and counts what passes through it.
+/// The counters are atomic so tests may allocate from several threads at once.
+class counting_resource : public std::pmr::memory_resource {
+public:
+	std::atomic<std::size_t> allocations{0};
+	std::atomic<std::size_t> outstanding{0};  // Blocks allocated and not yet deallocated
+	std::atomic<std::size_t> outstanding_bytes{0};
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		++allocations;
+		++outstanding;
+		outstanding_bytes += bytes;
+		return std::pmr::get_default_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+		--outstanding;
+		outstanding_bytes -= bytes;
+		std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+} // end namespace genesis::tests
+
+#endif
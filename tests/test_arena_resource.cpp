@@ -0,0 +1,87 @@
+#include "genesis/arena_resource.hpp"
+
+#include "counting_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace {
+
+using genesis::tests::counting_resource;
+
+} // end namespace
+
+TEST_CASE("arena_resource bumps through the initial buffer", "[arena_resource]") {
+	counting_resource upstream{};
+	alignas(std::max_align_t) std::byte buffer[1024];
+	genesis::arena_resource arena{buffer, sizeof(buffer), &upstream};
+	auto* a = arena.allocate(10, 1);
+	auto* b = arena.allocate(64, 64);
+	REQUIRE(a == buffer);
+	REQUIRE(reinterpret_cast<std::uintptr_t>(b) % 64 == 0);
+	REQUIRE(static_cast<std::byte*>(b) > static_cast<std::byte*>(a));
+	REQUIRE(static_cast<std::byte*>(b) < buffer + sizeof(buffer));
+	REQUIRE(upstream.allocations == 0);
+	arena.deallocate(a, 10, 1);
+	REQUIRE(arena.allocate(10, 1) != a);
+}
+
+TEST_CASE("arena_resource chains overflow blocks from upstream", "[arena_resource]") {
+	counting_resource upstream{};
+	{
+		genesis::arena_resource arena{&upstream};
+		auto* big = arena.allocate(100000, 16);
+		std::memset(big, 1, 100000);
+		auto* small = arena.allocate(16, 16);
+		REQUIRE(small != big);
+		REQUIRE(upstream.allocations >= 1);
+		REQUIRE(arena.block_count() == upstream.outstanding);
+	}
+	REQUIRE(upstream.outstanding == 0);
+}
+
+TEST_CASE("arena_resource rewinds to a mark and reuses its blocks", "[arena_resource]") {
+	counting_resource upstream{};
+	genesis::inline_arena_resource<256> arena{&upstream};
+	auto* keep = arena.allocate(32, 8);
+	auto start = arena.mark();
+	auto* first = arena.allocate(32, 8);
+	for (std::size_t request = 0; request < 100; ++request) {
+		arena.rewind(start);
+		std::pmr::vector<std::pmr::string> scratch{&arena};
+		for (std::size_t i = 0; i < 50; ++i) { scratch.emplace_back(100, 'x'); }
+		REQUIRE(scratch.back().size() == 100);
+		auto* again = arena.allocate(32, 8);
+		(void) again;
+	}
+	auto blocks = upstream.allocations.load();
+	REQUIRE(blocks == arena.block_count());
+	for (std::size_t request = 0; request < 100; ++request) {
+		arena.rewind(start);
+		std::pmr::vector<std::pmr::string> scratch{&arena};
+		for (std::size_t i = 0; i < 50; ++i) { scratch.emplace_back(100, 'x'); }
+	}
+	// Steady state never reaches the upstream resource.
+	REQUIRE(upstream.allocations == blocks);
+	arena.rewind(start);
+	REQUIRE(arena.allocate(32, 8) == first);
+	REQUIRE(keep != first);
+	arena.release();
+	REQUIRE(upstream.outstanding == 0);
+	REQUIRE(arena.block_count() == 0);
+}
+
+TEST_CASE("arena_resource reset frees everything", "[arena_resource]") {
+	genesis::inline_arena_resource<128> arena{};
+	auto* first = arena.allocate(8, 8);
+	REQUIRE(arena.allocate(1000, 8) != nullptr);
+	arena.reset();
+	REQUIRE(arena.allocate(8, 8) == first);
+	REQUIRE(arena.is_equal(arena));
+}
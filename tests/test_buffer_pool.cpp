@@ -0,0 +1,110 @@
+#include "genesis/buffer_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("buffer_pool serves requests from power of two size classes", "[buffer_pool]") {
+	genesis::buffer_pool pool{};
+	REQUIRE(pool.class_count() == 12);
+	REQUIRE(pool.max_size() == std::size_t{1} << 20);
+	auto small = pool.try_allocate(100);
+	REQUIRE(small);
+	REQUIRE(small.size() == 100);
+	REQUIRE(small.capacity() == 512);
+	auto odd = pool.try_allocate(5000);
+	REQUIRE(odd.capacity() == 8192);
+	auto large = pool.try_allocate(std::size_t{1} << 20);
+	REQUIRE(large.capacity() == std::size_t{1} << 20);
+	REQUIRE_THROWS_AS(pool.try_allocate((std::size_t{1} << 20) + 1), std::length_error);
+}
+
+TEST_CASE("buffer_pool size classes default to lazy pools of 64 buffers", "[buffer_pool]") {
+	genesis::buffer_pool_options opts{};
+	genesis::object_pool_options defaults{};
+	REQUIRE(opts.class_options.capacity == 64);
+	REQUIRE(opts.class_options.construction == genesis::pool_construction::lazy);
+	REQUIRE(opts.class_options.magazine_size == defaults.magazine_size);
+	REQUIRE(opts.class_options.max_capacity == defaults.max_capacity);
+	REQUIRE(opts.class_options.idle_release == defaults.idle_release);
+	REQUIRE(opts.class_options.recycle == defaults.recycle);
+}
+
+TEST_CASE("buffer_pool aligns buffers for direct I/O", "[buffer_pool]") {
+	genesis::buffer_pool pool{};
+	auto small = pool.try_allocate(512);
+	auto page = pool.try_allocate(4096);
+	auto large = pool.try_allocate(65536);
+	REQUIRE(reinterpret_cast<std::uintptr_t>(small.data()) % 512 == 0);
+	REQUIRE(reinterpret_cast<std::uintptr_t>(page.data()) % 4096 == 0);
+	REQUIRE(reinterpret_cast<std::uintptr_t>(large.data()) % 4096 == 0);
+}
+
+TEST_CASE("pool_buffer returns itself to its size class", "[buffer_pool]") {
+	genesis::buffer_pool_options opts{};
+	opts.max_size = 4096;
+	opts.class_options.capacity = 1;
+	genesis::buffer_pool pool{opts};
+	auto buffer = pool.try_allocate(1000);
+	std::memset(buffer.data(), 0xab, buffer.size());
+	auto* data = buffer.data();
+	REQUIRE_FALSE(pool.try_allocate(600));
+	REQUIRE(pool.try_allocate(200));
+	auto stats = pool.stats();
+	REQUIRE(stats.size() == 4);
+	REQUIRE(stats[1].size == 1024);
+	REQUIRE(stats[1].borrowed == 1);
+	REQUIRE(stats[0].borrowed == 0);
+	auto moved = std::move(buffer);
+	REQUIRE_FALSE(buffer);
+	REQUIRE(moved.data() == data);
+	moved.resize(moved.capacity());
+	REQUIRE(moved.size() == 1024);
+	REQUIRE_THROWS_AS(moved.resize(1025), std::length_error);
+	moved.reset();
+	REQUIRE(pool.stats()[1].borrowed == 0);
+	REQUIRE(pool.try_allocate(1024).data() == data);
+}
+
+TEST_CASE("buffer_pool rejects invalid options", "[buffer_pool]") {
+	genesis::buffer_pool_options opts{};
+	opts.alignment = 3000;
+	REQUIRE_THROWS_AS(genesis::buffer_pool{opts}, std::invalid_argument);
+	opts = {};
+	opts.min_size = 8192;
+	opts.max_size = 4096;
+	REQUIRE_THROWS_AS(genesis::buffer_pool{opts}, std::invalid_argument);
+}
+
+TEST_CASE("buffer_pool is thread safe", "[buffer_pool][thread_safety]") {
+	constexpr std::size_t thread_count = 8;
+	constexpr std::size_t borrows = 2000;
+	genesis::buffer_pool_options opts{};
+	opts.max_size = 16384;
+	opts.class_options.capacity = 4;
+	genesis::buffer_pool pool{opts};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> threads{};
+	for (std::size_t t = 0; t < thread_count; ++t) {
+		threads.emplace_back([&pool, &failures, t] {
+			for (std::size_t i = 0; i < borrows; ++i) {
+				auto size = std::size_t{1} << (9 + (i + t) % 6);
+				auto buffer = pool.allocate_for(size, std::chrono::seconds{5});
+				if (!buffer || buffer.capacity() != size) {
+					failures.fetch_add(1);
+					continue;
+				}
+				std::memset(buffer.data(), static_cast<int>(t), buffer.size());
+			}
+		});
+	}
+	for (auto& t : threads) { t.join(); }
+	REQUIRE(failures == 0);
+	for (const auto& cls : pool.stats()) { REQUIRE(cls.borrowed == 0); }
+}
@@ -1,7 +1,9 @@
 #include "genesis/config.hpp"
+#include "genesis/utility.hpp"
 
 #include <catch2/catch_all.hpp>
 
+#include <atomic>
 #include <cstdint>
 
 TEST_CASE("Test case for compilation between different platforms", "[config][platforms]") {
@@ -28,4 +30,17 @@ TEST_CASE("Test case for detecting architecture", "[config][architecture]") {
 	REQUIRE(1 == aarch64);
 	REQUIRE(aarch64 != x86_64);
 	#endif
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test case for the cache line size", "[config][cacheline]") {
+	STATIC_REQUIRE(GENESIS_CACHELINE_SIZE >= 64);
+	STATIC_REQUIRE((GENESIS_CACHELINE_SIZE & (GENESIS_CACHELINE_SIZE - 1)) == 0);
+	STATIC_REQUIRE(genesis::hardware_destructive_interference_size == GENESIS_CACHELINE_SIZE);
+	STATIC_REQUIRE(alignof(genesis::cache_padded<std::atomic<uint32_t>>) == GENESIS_CACHELINE_SIZE);
+	STATIC_REQUIRE(sizeof(genesis::cache_padded<std::atomic<uint32_t>>) == GENESIS_CACHELINE_SIZE);
+	genesis::cache_padded<std::atomic<uint32_t>> padded[2]{genesis::cache_padded<std::atomic<uint32_t>>{1u}, genesis::cache_padded<std::atomic<uint32_t>>{2u}};
+	auto distance = reinterpret_cast<const char*>(&padded[1].value) - reinterpret_cast<const char*>(&padded[0].value);
+	REQUIRE(distance == GENESIS_CACHELINE_SIZE);
+	REQUIRE(padded[0]->load() == 1);
+	REQUIRE(*padded[1] == 2);
+}
@@ -0,0 +1,69 @@
+#include "genesis/hugepage_resource.hpp"
+#include "genesis/object_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+TEST_CASE("hugepage_resource maps large allocations and reports their backing", "[hugepage_resource]") {
+	genesis::hugepage_resource resource{};
+	constexpr std::size_t size = std::size_t{3} << 20;
+	auto* p = resource.allocate(size, 64);
+	REQUIRE(p != nullptr);
+	std::memset(p, 0x5a, size);
+	auto stats = resource.stats();
+	REQUIRE(stats.mappings == 1);
+	REQUIRE(stats.hugetlb_bytes + stats.transparent_requested_bytes + stats.normal_bytes >= size);
+	switch (resource.backing_of(p)) {
+		case genesis::page_backing::hugetlb: REQUIRE(stats.hugetlb_bytes >= size); break;
+		case genesis::page_backing::transparent_requested: REQUIRE(stats.transparent_requested_bytes >= size); break;
+		case genesis::page_backing::normal: REQUIRE(stats.normal_bytes >= size); break;
+	}
+	resource.deallocate(p, size, 64);
+	stats = resource.stats();
+	REQUIRE(stats.mappings == 0);
+	REQUIRE(stats.hugetlb_bytes + stats.transparent_requested_bytes + stats.normal_bytes == 0);
+}
+
+TEST_CASE("hugepage_resource falls back to normal pages", "[hugepage_resource]") {
+	genesis::hugepage_resource_options opts{};
+	opts.use_hugetlb = false;
+	opts.use_transparent = false;
+	genesis::hugepage_resource resource{opts};
+	auto* p = resource.allocate(std::size_t{1} << 20, 1 << 16);
+	REQUIRE(reinterpret_cast<std::uintptr_t>(p) % (1 << 16) == 0);
+	REQUIRE(resource.backing_of(p) == genesis::page_backing::normal);
+	REQUIRE(resource.stats().normal_bytes == std::size_t{1} << 20);
+	resource.deallocate(p, std::size_t{1} << 20, 1 << 16);
+}
+
+TEST_CASE("hugepage_resource passes small allocations upstream", "[hugepage_resource]") {
+	genesis::hugepage_resource resource{};
+	auto* p = resource.allocate(128, 16);
+	REQUIRE(resource.stats().upstream_bytes == 128);
+	REQUIRE(resource.stats().mappings == 0);
+	resource.deallocate(p, 128, 16);
+	REQUIRE(resource.stats().upstream_bytes == 0);
+	REQUIRE(resource.is_equal(resource));
+	genesis::hugepage_resource other{};
+	REQUIRE_FALSE(resource.is_equal(other));
+}
+
+TEST_CASE("hugepage_resource backs an object_pool and pmr containers", "[hugepage_resource]") {
+	genesis::hugepage_resource resource{};
+	{
+		genesis::object_pool<std::array<uint64_t, 8>> pool{65536, &resource};
+		REQUIRE(resource.stats().mappings >= 1);
+		auto obj = pool.try_allocate();
+		REQUIRE(obj);
+		std::pmr::vector<uint64_t> values{&resource};
+		values.resize(1 << 20, 7);
+		REQUIRE(values.back() == 7);
+	}
+	REQUIRE(resource.stats().mappings == 0);
+	REQUIRE(resource.stats().upstream_bytes == 0);
+}
@@ -0,0 +1,140 @@
+#include "genesis/inplace_function.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+int add(int a, int b) { return a + b; }
+
+/// @brief Counts live instances so tests can check the stored callable is destroyed exactly once.
+struct counted {
+	static inline int live = 0;
+	int value;
+
+	explicit counted(int init_value) noexcept : value{init_value} { ++live; }
+
+	counted(counted&& other) noexcept : value{other.value} { ++live; }
+
+	~counted() { --live; }
+
+	int operator()() const noexcept { return value; }
+};
+
+/// @brief A capture that remembers where its latest copy or move lives.
+struct located {
+	static inline const void* last = nullptr;
+	std::array<char, 48> payload;
+
+	explicit located(char value) noexcept : payload{} { payload[47] = value; last = this; }
+
+	located(const located& other) noexcept : payload{other.payload} { last = this; }
+
+	located(located&& other) noexcept : payload{other.payload} { last = this; }
+};
+
+/// @brief Whether the latest located copy sits inside the storage of object.
+template <typename T>
+bool located_in(const T& object) {
+	auto* begin = reinterpret_cast<const std::byte*>(&object);
+	auto* stored = static_cast<const std::byte*>(located::last);
+	return stored >= begin && stored < begin + sizeof(object);
+}
+
+} // end namespace
+
+TEST_CASE("inplace_function calls lambdas, function pointers and functors", "[inplace_function]") {
+	genesis::inplace_function<int(int, int)> f{add};
+	REQUIRE(f(2, 3) == 5);
+	int offset = 10;
+	f = [offset](int a, int b) { return a * b + offset; };
+	REQUIRE(f(2, 3) == 16);
+	f = std::plus<>{};
+	REQUIRE(f(4, 4) == 8);
+	genesis::inplace_function<void(std::string&)> append{[](std::string& s) { s += "!"; }};
+	std::string s{"hi"};
+	append(s);
+	REQUIRE(s == "hi!");
+}
+
+TEST_CASE("inplace_function is move only and never allocates", "[inplace_function]") {
+	using function = genesis::inplace_function<int(), 64>;
+	STATIC_REQUIRE_FALSE(std::is_copy_constructible_v<function>);
+	STATIC_REQUIRE(std::is_nothrow_move_constructible_v<function>);
+	STATIC_REQUIRE(sizeof(function) <= 64 + 2 * sizeof(void*) + alignof(std::max_align_t));
+	auto owned = std::make_unique<int>(42);
+	function f{[p = std::move(owned)] { return *p; }};
+	REQUIRE(f() == 42);
+	function g{std::move(f)};
+	REQUIRE_FALSE(f);
+	REQUIRE(g);
+	REQUIRE(g() == 42);
+	// A capture that fills most of the capacity is still stored inline, and a move relocates it into the target.
+	located payload{7};
+	function big{[payload] { return static_cast<int>(payload.payload[47]); }};
+	REQUIRE(located_in(big));
+	REQUIRE(big() == 7);
+	function moved{std::move(big)};
+	REQUIRE(located_in(moved));
+	REQUIRE(moved() == 7);
+}
+
+TEST_CASE("inplace_function destroys its callable exactly once", "[inplace_function]") {
+	counted::live = 0;
+	{
+		genesis::inplace_function<int()> f{counted{3}};
+		REQUIRE(counted::live == 1);
+		auto g = std::move(f);
+		REQUIRE(counted::live == 1);
+		REQUIRE(g() == 3);
+		g = nullptr;
+		REQUIRE(counted::live == 0);
+		REQUIRE(g == nullptr);
+		g = counted{4};
+		f = counted{5};
+		swap(f, g);
+		REQUIRE(f() == 4);
+		REQUIRE(g() == 5);
+		REQUIRE(counted::live == 2);
+	}
+	REQUIRE(counted::live == 0);
+}
+
+TEST_CASE("empty inplace_function throws bad_function_call", "[inplace_function]") {
+	genesis::inplace_function<void()> f{};
+	REQUIRE_FALSE(f);
+	REQUIRE(f == nullptr);
+	REQUIRE_THROWS_AS(f(), std::bad_function_call);
+	void (*null_fn)() = nullptr;
+	genesis::inplace_function<void()> g{null_fn};
+	REQUIRE_FALSE(g);
+}
+
+TEST_CASE("inplace_function converts to a larger capacity", "[inplace_function]") {
+	counted::live = 0;
+	genesis::inplace_function<int(), 16> small{counted{9}};
+	genesis::inplace_function<int(), 64> large{std::move(small)};
+	REQUIRE_FALSE(small);
+	REQUIRE(large() == 9);
+	REQUIRE(counted::live == 1);
+	STATIC_REQUIRE_FALSE(std::is_constructible_v<genesis::inplace_function<int(), 16>, genesis::inplace_function<int(), 64>&&>);
+}
+
+TEST_CASE("inplace_function stores heterogeneous callbacks in a container", "[inplace_function]") {
+	std::vector<genesis::inplace_function<void(int&)>> callbacks{};
+	int step = 3;
+	callbacks.emplace_back([](int& x) { x += 1; });
+	callbacks.emplace_back([step](int& x) { x *= step; });
+	callbacks.emplace_back([&step](int& x) { x -= step; });
+	int value = 1;
+	for (auto& cb : callbacks) { cb(value); }
+	REQUIRE(value == 3);
+}
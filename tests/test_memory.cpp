@@ -0,0 +1,196 @@
+#include "genesis/memory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// @brief Owns a heap buffer through a pointer and opts in to trivial relocation.
+struct heap_buffer {
+	int* data;
+
+	explicit heap_buffer(int value) : data{new int{value}} { }
+
+	heap_buffer(heap_buffer&& other) noexcept : data{std::exchange(other.data, nullptr)} { }
+
+	~heap_buffer() { delete data; }
+};
+
+/// @brief Counts live objects and throws from its copy or move constructor on request.
+struct tracked {
+	static inline int live = 0;
+	static inline int throw_after = -1;
+	int value;
+
+	explicit tracked(int init_value) : value{init_value} { ++live; }
+
+	tracked(const tracked& other) : value{other.value} {
+		if (throw_after == 0) { throw std::runtime_error{"copy"}; }
+		--throw_after;
+		++live;
+	}
+
+	tracked(tracked&& other) : value{other.value} {
+		if (throw_after == 0) { throw std::runtime_error{"move"}; }
+		--throw_after;
+		++live;
+	}
+
+	~tracked() { --live; }
+};
+
+template <typename T>
+struct raw_storage {
+	alignas(T) std::byte bytes[sizeof(T) * 8];
+
+	T* get() noexcept { return reinterpret_cast<T*>(bytes); }
+};
+
+} // end namespace
+
+namespace genesis {
+
+template <>
+struct is_trivially_relocatable<heap_buffer> : std::true_type {};
+
+} // end namespace genesis
+
+TEST_CASE("is_trivially_relocatable defaults", "[memory]") {
+	STATIC_REQUIRE(genesis::is_trivially_relocatable_v<int>);
+	STATIC_REQUIRE(genesis::is_trivially_relocatable_v<double[3]>);
+	STATIC_REQUIRE(genesis::is_trivially_relocatable_v<std::unique_ptr<int>>);
+	STATIC_REQUIRE(genesis::is_trivially_relocatable_v<std::unique_ptr<int[]>>);
+	STATIC_REQUIRE(genesis::is_trivially_relocatable_v<std::shared_ptr<std::string>>);
+	STATIC_REQUIRE(genesis::is_trivially_relocatable_v<std::weak_ptr<int>>);
+	STATIC_REQUIRE(genesis::is_trivially_relocatable_v<heap_buffer>);
+	STATIC_REQUIRE_FALSE(genesis::is_trivially_relocatable_v<std::string>);
+	STATIC_REQUIRE_FALSE(genesis::is_trivially_relocatable_v<tracked>);
+}
+
+TEST_CASE("relocate_at moves trivially relocatable objects bytewise", "[memory]") {
+	raw_storage<std::shared_ptr<int>> from{};
+	raw_storage<std::shared_ptr<int>> to{};
+	auto* source = genesis::construct_at(from.get(), std::make_shared<int>(42));
+	std::weak_ptr<int> observer = *source;
+	auto* relocated = genesis::relocate_at(source, to.get());
+	REQUIRE(**relocated == 42);
+	REQUIRE(relocated->use_count() == 1);
+	std::destroy_at(relocated);
+	REQUIRE(observer.expired());
+}
+
+TEST_CASE("relocate_at falls back to move and destroy", "[memory]") {
+	raw_storage<tracked> from{};
+	raw_storage<tracked> to{};
+	tracked::live = 0;
+	auto* source = genesis::construct_at(from.get(), 7);
+	auto* relocated = genesis::relocate_at(source, to.get());
+	REQUIRE(relocated->value == 7);
+	REQUIRE(tracked::live == 1);
+	std::destroy_at(relocated);
+	REQUIRE(tracked::live == 0);
+}
+
+TEST_CASE("uninitialized_relocate handles overlapping trivially relocatable ranges", "[memory]") {
+	raw_storage<heap_buffer> storage{};
+	auto* first = storage.get() + 2;
+	for (int i = 0; i < 4; ++i) { genesis::construct_at(first + i, i); }
+	auto* end = genesis::uninitialized_relocate(first, first + 4, storage.get());
+	REQUIRE(end == storage.get() + 4);
+	for (int i = 0; i < 4; ++i) { REQUIRE(*storage.get()[i].data == i); }
+	std::destroy(storage.get(), end);
+}
+
+TEST_CASE("uninitialized_relocate_n works with non pointer iterators", "[memory]") {
+	std::list<std::string> source{"alpha", "beta", "gamma"};
+	raw_storage<std::string> storage{};
+	// The list nodes keep their moved-from strings alive, so rebuild them after the relocation for the list to destroy.
+	auto [source_end, dest_end] = genesis::uninitialized_relocate_n(source.begin(), 3, storage.get());
+	REQUIRE(source_end == source.end());
+	REQUIRE(dest_end == storage.get() + 3);
+	for (auto& s : source) { genesis::construct_at(&s); }
+	REQUIRE(storage.get()[0] == "alpha");
+	REQUIRE(storage.get()[2] == "gamma");
+	std::destroy(storage.get(), dest_end);
+}
+
+TEST_CASE("uninitialized_relocate destroys both ranges when a move throws", "[memory]") {
+	raw_storage<tracked> from{};
+	raw_storage<tracked> to{};
+	tracked::live = 0;
+	for (int i = 0; i < 5; ++i) { genesis::construct_at(from.get() + i, i); }
+	tracked::throw_after = 2;
+	REQUIRE_THROWS_AS(genesis::uninitialized_relocate(from.get(), from.get() + 5, to.get()), std::runtime_error);
+	REQUIRE(tracked::live == 0);
+	tracked::throw_after = -1;
+}
+
+TEST_CASE("uninitialized_fill_n stamps out trivially copyable values", "[memory]") {
+	raw_storage<uint32_t> ones{};
+	auto* end = genesis::uninitialized_fill_n(ones.get(), 8, UINT32_MAX);
+	REQUIRE(end == ones.get() + 8);
+	for (int i = 0; i < 8; ++i) { REQUIRE(ones.get()[i] == UINT32_MAX); }
+	raw_storage<uint32_t> mixed{};
+	genesis::uninitialized_fill_n(mixed.get(), 8, 0x01020304u);
+	for (int i = 0; i < 8; ++i) { REQUIRE(mixed.get()[i] == 0x01020304u); }
+	raw_storage<std::atomic<uint32_t>> links{};
+	genesis::uninitialized_fill_n(links.get(), 8, 7u);
+	REQUIRE(links.get()[7].load() == 7);
+	REQUIRE(genesis::uninitialized_fill_n(links.get(), 0, 7u) == links.get());
+}
+
+TEST_CASE("uninitialized_fill_n copies non trivial values", "[memory]") {
+	raw_storage<std::string> storage{};
+	std::string value(100, 'x');
+	auto* end = genesis::uninitialized_fill_n(storage.get(), 8, value);
+	REQUIRE(storage.get()[5] == value);
+	REQUIRE(genesis::destroy_n(storage.get(), 8) == end);
+}
+
+TEST_CASE("uninitialized_value_construct_n zeroes trivial types", "[memory]") {
+	raw_storage<double> doubles{};
+	std::memset(doubles.bytes, 0xab, sizeof(doubles.bytes));
+	genesis::uninitialized_value_construct_n(doubles.get(), 8);
+	for (int i = 0; i < 8; ++i) { REQUIRE(doubles.get()[i] == 0.0); }
+	struct member { int value; };
+	raw_storage<int member::*> members{};
+	genesis::uninitialized_value_construct_n(members.get(), 8);
+	for (int i = 0; i < 8; ++i) { REQUIRE(members.get()[i] == nullptr); }
+	raw_storage<std::vector<int>> vectors{};
+	genesis::uninitialized_value_construct_n(vectors.get(), 8);
+	REQUIRE(vectors.get()[3].empty());
+	genesis::destroy_n(vectors.get(), 8);
+}
+
+TEST_CASE("uninitialized_default_construct_n leaves trivial types alone", "[memory]") {
+	raw_storage<int> ints{};
+	std::memset(ints.bytes, 0x11, sizeof(ints.bytes));
+	REQUIRE(genesis::uninitialized_default_construct_n(ints.get(), 8) == ints.get() + 8);
+	REQUIRE(ints.get()[0] == 0x11111111);
+	raw_storage<std::string> strings{};
+	genesis::uninitialized_default_construct_n(strings.get(), 8);
+	REQUIRE(strings.get()[7].empty());
+	genesis::destroy_n(strings.get(), 8);
+}
+
+TEST_CASE("bulk construction destroys what it built when a constructor throws", "[memory]") {
+	raw_storage<tracked> source{};
+	raw_storage<tracked> storage{};
+	tracked::live = 0;
+	auto* prototype = genesis::construct_at(source.get(), 3);
+	tracked::throw_after = 4;
+	REQUIRE_THROWS_AS(genesis::uninitialized_fill_n(storage.get(), 8, *prototype), std::runtime_error);
+	REQUIRE(tracked::live == 1);
+	tracked::throw_after = -1;
+	std::destroy_at(prototype);
+}
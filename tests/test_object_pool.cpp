@@ -1,10 +1,38 @@
 #include "genesis/object_pool.hpp"
 
+#include "counting_resource.hpp"
+
 #include <catch2/catch_all.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
+namespace {
+
+using genesis::tests::counting_resource;
+
+struct packed_counter {
+	uint64_t value;
+};
+
+} // end namespace
+
+namespace genesis {
+
+template <>
+struct object_pool_padding<packed_counter> : std::false_type {};
+
+} // end namespace genesis
+
 TEST_CASE("object_pool construction with no generator", "[object_pool][constructor]") {
 	struct foo { };
 	genesis::object_pool<foo> pool{42};
@@ -65,4 +93,774 @@ TEST_CASE("object_pool thread safe", "[object_pool][thread_safety]") {
 	work2.join();
 	REQUIRE(obj_holder_one.size() == 21);
 	REQUIRE(obj_holder_two.size() == 21);
-}
\ No newline at end of file
+}
+
+TEST_CASE("object_pool with magazines allocates the full capacity", "[object_pool][magazine]") {
+	struct foo { };
+	genesis::object_pool<foo> pool{genesis::object_pool_options{42, 8}};
+	REQUIRE(pool.magazine_size() == 8);
+	std::vector<std::shared_ptr<foo>> obj_holder{};
+	for (std::size_t i = 0; i < pool.capacity(); ++i) {
+		auto o = pool.allocate();
+		REQUIRE(o != std::nullopt);
+		obj_holder.emplace_back(*o);
+	}
+	REQUIRE(pool.allocate() == std::nullopt);
+}
+
+TEST_CASE("object_pool magazines are returned on thread exit", "[object_pool][magazine]") {
+	struct foo { };
+	genesis::object_pool<foo> pool{genesis::object_pool_options{42, 8}};
+	auto work = std::thread{[&pool] {
+		std::vector<std::shared_ptr<foo>> obj_holder{};
+		for (std::size_t i = 0; i < 16; ++i) {
+			obj_holder.emplace_back(*pool.allocate());
+		}
+	}};
+	work.join();
+	std::vector<std::shared_ptr<foo>> obj_holder{};
+	for (std::size_t i = 0; i < pool.capacity(); ++i) {
+		auto o = pool.allocate();
+		REQUIRE(o != std::nullopt);
+		obj_holder.emplace_back(*o);
+	}
+}
+
+TEST_CASE("object_pool magazines thread safe", "[object_pool][magazine][thread_safety]") {
+	genesis::object_pool<uint64_t> pool{genesis::object_pool_options{64, 4}};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> workers{};
+	for (std::size_t t = 0; t < 4; ++t) {
+		workers.emplace_back([&pool, &failures, t] {
+			for (std::size_t i = 0; i < 10000; ++i) {
+				auto o = pool.allocate();
+				if (!o) { ++failures; continue; }
+				**o = t;
+				std::this_thread::yield();
+				if (**o != t) { ++failures; }
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	REQUIRE(failures == 0);
+	std::vector<std::shared_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < pool.capacity(); ++i) {
+		obj_holder.emplace_back(*pool.allocate());
+	}
+	REQUIRE(obj_holder.size() == 64);
+}
+
+TEST_CASE("object_pool never hands out the same object twice under churn", "[object_pool][thread_safety][aba]") {
+	// Every object records whether it is currently borrowed, a corrupted freelist would hand the same
+	// node to two threads at once.
+	struct slot {
+		std::atomic<uint32_t> borrowed{0};
+		slot() = default;
+		slot(slot&&) noexcept { }
+	};
+	constexpr std::size_t threads = 4;
+	constexpr std::size_t held = 3;
+	genesis::object_pool<slot> pool{threads * held};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> workers{};
+	for (std::size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&pool, &failures] {
+			std::shared_ptr<slot> objs[held];
+			for (std::size_t i = 0; i < 20000; ++i) {
+				for (auto& o : objs) {
+					auto p = pool.allocate();
+					if (!p) { ++failures; continue; }
+					o = std::move(*p);
+					if (o->borrowed.exchange(1) != 0) { ++failures; }
+				}
+				// Return in a different order than borrowed so the freelist keeps getting reshuffled.
+				for (std::size_t j = 0; j < held; ++j) {
+					auto& o = objs[(i + j) % held];
+					if (o) { o->borrowed.store(0); }
+					o.reset();
+				}
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	REQUIRE(failures == 0);
+}
+
+TEST_CASE("object_pool pool_ptr is pointer sized", "[object_pool][pool_ptr]") {
+	STATIC_REQUIRE(sizeof(genesis::pool_ptr<uint64_t>) == sizeof(void*));
+	STATIC_REQUIRE(!std::is_copy_constructible_v<genesis::pool_ptr<uint64_t>>);
+	STATIC_REQUIRE(std::is_nothrow_move_constructible_v<genesis::pool_ptr<uint64_t>>);
+}
+
+TEST_CASE("object_pool try_allocate returns objects to the pool", "[object_pool][pool_ptr]") {
+	genesis::object_pool<uint64_t> pool{2};
+	auto a = pool.try_allocate();
+	auto b = pool.allocate_unique();
+	REQUIRE(a);
+	REQUIRE(b != nullptr);
+	*a = 42;
+	REQUIRE(*a.get() == 42);
+	auto c = pool.try_allocate();
+	REQUIRE(c == nullptr);
+	a.reset();
+	REQUIRE(a == nullptr);
+	c = pool.try_allocate();
+	REQUIRE(c);
+	REQUIRE(*c == 42);
+}
+
+TEST_CASE("object_pool pool_ptr move semantics", "[object_pool][pool_ptr]") {
+	genesis::object_pool<uint64_t> pool{1};
+	auto a = pool.try_allocate();
+	auto b = std::move(a);
+	REQUIRE(a == nullptr);
+	REQUIRE(b != nullptr);
+	REQUIRE(!pool.try_allocate());
+	genesis::pool_ptr<uint64_t> c{};
+	c = std::move(b);
+	REQUIRE(!pool.try_allocate());
+	c = nullptr;
+	REQUIRE(pool.try_allocate());
+}
+
+TEST_CASE("object_pool shared_ptr returns once weak references are gone", "[object_pool][allocate]") {
+	genesis::object_pool<uint64_t> pool{1};
+	auto o = pool.allocate();
+	REQUIRE(o != std::nullopt);
+	std::weak_ptr<uint64_t> weak = *o;
+	o.reset();
+	REQUIRE(weak.expired());
+	REQUIRE(!pool.try_allocate());
+	weak.reset();
+	REQUIRE(pool.try_allocate());
+}
+
+TEST_CASE("object_pool only sets aside control blocks once it hands out a shared_ptr", "[object_pool][allocate]") {
+	counting_resource resource{};
+	{
+		genesis::object_pool<uint64_t> pool{16, &resource};
+		auto before = resource.outstanding_bytes.load();
+		auto unique = pool.try_allocate();
+		unique.reset();
+		REQUIRE(resource.outstanding_bytes == before);
+		auto first = pool.allocate();
+		REQUIRE(first != std::nullopt);
+		REQUIRE(resource.outstanding_bytes == before + 16 * genesis::details::control_block_size);
+		auto second = pool.allocate();
+		REQUIRE(second != std::nullopt);
+		REQUIRE(resource.outstanding_bytes == before + 16 * genesis::details::control_block_size);
+	}
+	REQUIRE(resource.outstanding_bytes == 0);
+}
+
+TEST_CASE("object_pool stores its nodes in a single slab", "[object_pool][slab]") {
+	counting_resource resource{};
+	{
+		genesis::object_pool<uint64_t> pool{1000, &resource};
+		// The slab of nodes and the freelist links.
+		REQUIRE(resource.allocations == 2);
+		using node = genesis::object_pool<uint64_t>::node;
+		REQUIRE(resource.outstanding_bytes == genesis::details::slab_alignment + 1000 * sizeof(node) + 1000 * sizeof(uint32_t));
+		auto first = pool.try_allocate();
+		auto second = pool.try_allocate();
+		auto distance = reinterpret_cast<std::byte*>(second.get()) - reinterpret_cast<std::byte*>(first.get());
+		REQUIRE(static_cast<std::size_t>(distance) == sizeof(genesis::object_pool<uint64_t>::node));
+	}
+	REQUIRE(resource.outstanding_bytes == 0);
+}
+
+TEST_CASE("object_pool nodes only add a 32-bit offset to the object", "[object_pool][slab]") {
+	struct message {
+		uint64_t id;
+		uint64_t payload[7];
+	};
+	STATIC_REQUIRE(sizeof(genesis::object_pool<int>::node) == 8);
+	STATIC_REQUIRE(sizeof(genesis::object_pool<uint64_t>::node) == 16);
+	STATIC_REQUIRE(sizeof(genesis::object_pool<message>::node) == 72);
+	STATIC_REQUIRE(sizeof(genesis::object_pool<message, genesis::pool_single_thread>::node) == 72);
+}
+
+TEST_CASE("object_pool packs its hot fields for types that opt out of padding", "[object_pool][padding]") {
+	STATIC_REQUIRE(alignof(genesis::object_pool<uint64_t>) == genesis::hardware_destructive_interference_size);
+	STATIC_REQUIRE(alignof(genesis::object_pool<packed_counter>) < genesis::hardware_destructive_interference_size);
+	STATIC_REQUIRE(sizeof(genesis::object_pool<packed_counter>) < sizeof(genesis::object_pool<uint64_t>));
+	genesis::object_pool<packed_counter> pool{2};
+	auto first = pool.try_allocate();
+	auto second = pool.try_allocate();
+	REQUIRE(first);
+	REQUIRE(second);
+	REQUIRE(!pool.try_allocate());
+	first.reset();
+	REQUIRE(pool.try_allocate());
+}
+
+TEST_CASE("object_pool releases its slab if a generator throws", "[object_pool][slab]") {
+	counting_resource resource{};
+	std::size_t generated = 0;
+	auto generator = [&generated] {
+		if (++generated == 10) { throw std::runtime_error{"generator failed"}; }
+		return uint64_t{0};
+	};
+	REQUIRE_THROWS(genesis::object_pool<uint64_t>{42, generator, &resource});
+	REQUIRE(resource.outstanding_bytes == 0);
+}
+
+TEST_CASE("object_pool lazily constructs objects on first borrow", "[object_pool][lazy]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 8;
+	opts.construction = genesis::pool_construction::lazy;
+	std::size_t generated = 0;
+	genesis::object_pool<std::vector<uint64_t>> pool{opts, [&generated] { return std::vector<uint64_t>(++generated, 1); }};
+	REQUIRE(generated == 0);
+	REQUIRE(pool.capacity() == 8);
+	{
+		auto first = pool.try_allocate();
+		auto second = pool.allocate();
+		REQUIRE(first);
+		REQUIRE(second);
+		REQUIRE(first->size() == 1);
+		REQUIRE((*second)->size() == 2);
+		REQUIRE(generated == 2);
+	}
+	// Objects that were borrowed before are handed out again ahead of untouched storage.
+	REQUIRE(pool.try_allocate());
+	REQUIRE(generated == 2);
+	std::vector<genesis::pool_ptr<std::vector<uint64_t>>> obj_holder{};
+	for (std::size_t i = 0; i < 8; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+	REQUIRE(generated == 8);
+	REQUIRE_FALSE(pool.try_allocate());
+}
+
+TEST_CASE("object_pool retries a lazy construction whose generator threw", "[object_pool][lazy]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 2;
+	opts.construction = genesis::pool_construction::lazy;
+	std::size_t generated = 0;
+	auto generator = [&generated] {
+		if (++generated == 2) { throw std::runtime_error{"generator failed"}; }
+		return std::vector<uint64_t>(4, 1);
+	};
+	genesis::object_pool<std::vector<uint64_t>> pool{opts, generator};
+	auto first = pool.try_allocate();
+	REQUIRE(first);
+	REQUIRE_THROWS(pool.try_allocate());
+	auto second = pool.try_allocate();
+	REQUIRE(second);
+	REQUIRE(second->size() == 4);
+	REQUIRE_FALSE(pool.try_allocate());
+}
+
+TEST_CASE("object_pool only destroys lazily constructed objects", "[object_pool][lazy]") {
+	counting_resource resource{};
+	{
+		genesis::object_pool_options opts{};
+		opts.capacity = 16;
+		opts.construction = genesis::pool_construction::lazy;
+		genesis::object_pool<std::pmr::vector<uint64_t>> pool{opts, [&resource] {
+			return std::pmr::vector<uint64_t>(8, 1, &resource);
+		}, &resource};
+		auto allocations = resource.allocations.load();
+		auto first = pool.try_allocate();
+		REQUIRE(resource.allocations == allocations + 1);
+	}
+	REQUIRE(resource.outstanding_bytes == 0);
+}
+
+TEST_CASE("object_pool grows linearly up to its maximum capacity", "[object_pool][elastic]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 4;
+	opts.max_capacity = 10;
+	opts.chunk_size = 4;
+	genesis::object_pool<uint64_t> pool{opts};
+	REQUIRE(pool.capacity() == 4);
+	REQUIRE(pool.max_capacity() == 10);
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < 5; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+	}
+	REQUIRE(pool.capacity() == 8);
+	for (std::size_t i = 0; i < 5; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+	// The last chunk is cut short at the maximum capacity.
+	REQUIRE(pool.capacity() == 10);
+	REQUIRE(!pool.try_allocate());
+}
+
+TEST_CASE("object_pool grows geometrically", "[object_pool][elastic]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 4;
+	opts.max_capacity = 64;
+	opts.chunk_size = 2;
+	opts.growth = genesis::pool_growth::geometric;
+	genesis::object_pool<uint64_t> pool{opts};
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < 5; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+	}
+	REQUIRE(pool.capacity() == 8);
+	for (std::size_t i = 0; i < 4; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+	}
+	REQUIRE(pool.capacity() == 16);
+}
+
+TEST_CASE("object_pool starting empty grows on first use", "[object_pool][elastic]") {
+	genesis::object_pool_options opts{};
+	opts.max_capacity = 8;
+	opts.chunk_size = 8;
+	genesis::object_pool<uint64_t> pool{opts};
+	REQUIRE(pool.capacity() == 0);
+	auto o = pool.allocate();
+	REQUIRE(o != std::nullopt);
+	REQUIRE(pool.capacity() == 8);
+}
+
+TEST_CASE("object_pool releases idle chunks back to the memory resource", "[object_pool][elastic]") {
+	counting_resource resource{};
+	genesis::object_pool_options opts{};
+	opts.capacity = 4;
+	opts.max_capacity = 16;
+	opts.chunk_size = 4;
+	opts.idle_release = std::chrono::milliseconds{0};
+	genesis::object_pool<uint64_t> pool{opts, &resource};
+	auto initial_bytes = resource.outstanding_bytes.load();
+	{
+		std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+		for (std::size_t i = 0; i < 16; ++i) {
+			obj_holder.emplace_back(pool.try_allocate());
+		}
+		REQUIRE(pool.capacity() == 16);
+		// Keep one object of the last chunk borrowed.
+		auto keep = std::move(obj_holder.back());
+		obj_holder.clear();
+		REQUIRE(pool.trim() == 8);
+		REQUIRE(pool.capacity() == 8);
+	}
+	REQUIRE(pool.trim() == 4);
+	REQUIRE(pool.capacity() == 4);
+	REQUIRE(resource.outstanding_bytes == initial_bytes);
+	// Released chunks can be grown back into.
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < 16; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+}
+
+TEST_CASE("object_pool keeps chunks until they have been idle long enough", "[object_pool][elastic]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 4;
+	opts.max_capacity = 8;
+	opts.chunk_size = 4;
+	opts.idle_release = std::chrono::hours{1};
+	genesis::object_pool<uint64_t> pool{opts};
+	{
+		std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+		for (std::size_t i = 0; i < 8; ++i) {
+			obj_holder.emplace_back(pool.try_allocate());
+		}
+	}
+	REQUIRE(pool.trim() == 0);
+	REQUIRE(pool.capacity() == 8);
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < 8; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+}
+
+TEST_CASE("object_pool grows and trims thread safe", "[object_pool][elastic][thread_safety]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 2;
+	opts.max_capacity = 64;
+	opts.chunk_size = 2;
+	opts.idle_release = std::chrono::milliseconds{0};
+	genesis::object_pool<uint64_t> pool{opts};
+	std::atomic<std::size_t> failures{0};
+	std::atomic<bool> done{false};
+	auto trimmer = std::thread{[&pool, &done] {
+		while (!done) {
+			pool.trim();
+			std::this_thread::yield();
+		}
+	}};
+	std::vector<std::thread> workers{};
+	for (std::size_t t = 0; t < 4; ++t) {
+		workers.emplace_back([&pool, &failures, t] {
+			for (std::size_t i = 0; i < 5000; ++i) {
+				genesis::pool_ptr<uint64_t> objs[4];
+				for (auto& o : objs) {
+					o = pool.allocate_unique();
+					if (!o) { ++failures; continue; }
+					*o = t;
+				}
+				for (auto& o : objs) {
+					if (o && *o != t) { ++failures; }
+				}
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	done = true;
+	trimmer.join();
+	REQUIRE(failures == 0);
+	REQUIRE(pool.capacity() <= pool.max_capacity());
+}
+
+TEST_CASE("object_pool allocate_for times out on an exhausted pool", "[object_pool][wait]") {
+	genesis::object_pool<uint64_t> pool{1};
+	auto held = pool.try_allocate();
+	REQUIRE(held);
+	auto start = std::chrono::steady_clock::now();
+	REQUIRE_FALSE(pool.allocate_for(std::chrono::milliseconds{20}));
+	REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{20});
+	REQUIRE_FALSE(pool.allocate_unique_until(std::chrono::steady_clock::now() - std::chrono::seconds{1}));
+	REQUIRE(pool.waiters() == 0);
+}
+
+TEST_CASE("object_pool wakes a waiting borrower when an object is returned", "[object_pool][wait][thread_safety]") {
+	genesis::object_pool<uint64_t> pool{1};
+	auto held = pool.try_allocate();
+	REQUIRE(held);
+	std::atomic<bool> borrowed{false};
+	auto waiter = std::thread{[&pool, &borrowed] {
+		borrowed = static_cast<bool>(pool.allocate_unique_for(std::chrono::seconds{10}));
+	}};
+	while (pool.waiters() == 0) {
+		std::this_thread::yield();
+	}
+	held.reset();
+	waiter.join();
+	REQUIRE(borrowed);
+}
+
+TEST_CASE("object_pool stop request cancels a waiting borrower", "[object_pool][wait][thread_safety]") {
+	genesis::object_pool<uint64_t> pool{1};
+	auto held = pool.try_allocate();
+	REQUIRE(held);
+	genesis::inplace_stop_source source{};
+	std::atomic<bool> borrowed{true};
+	auto start = std::chrono::steady_clock::now();
+	auto waiter = std::thread{[&pool, &borrowed, token = source.get_token()] {
+		borrowed = pool.allocate(token).has_value();
+	}};
+	while (pool.waiters() == 0) {
+		std::this_thread::yield();
+	}
+	source.request_stop();
+	waiter.join();
+	REQUIRE_FALSE(borrowed);
+	REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds{5});
+	REQUIRE(pool.waiters() == 0);
+}
+
+TEST_CASE("object_pool allocate_n borrows what is available", "[object_pool][bulk]") {
+	genesis::object_pool<uint64_t> pool{8, [] { return uint64_t{7}; }};
+	std::vector<genesis::pool_ptr<uint64_t>> batch{};
+	REQUIRE(pool.allocate_n(5, std::back_inserter(batch)) == 5);
+	REQUIRE(batch.size() == 5);
+	for (const auto& o : batch) {
+		REQUIRE(o);
+		REQUIRE(*o == 7);
+	}
+	REQUIRE(pool.allocate_n(5, std::back_inserter(batch)) == 3);
+	REQUIRE(batch.size() == 8);
+	REQUIRE_FALSE(pool.try_allocate());
+	pool.deallocate_n(batch);
+	for (const auto& o : batch) {
+		REQUIRE_FALSE(o);
+	}
+	batch.clear();
+	REQUIRE(pool.allocate_n(8, std::back_inserter(batch)) == 8);
+}
+
+TEST_CASE("object_pool allocate_n grows an elastic pool", "[object_pool][bulk][elastic]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 4;
+	opts.max_capacity = 20;
+	opts.chunk_size = 4;
+	genesis::object_pool<uint64_t> pool{opts};
+	std::vector<genesis::pool_ptr<uint64_t>> batch{};
+	REQUIRE(pool.allocate_n(32, std::back_inserter(batch)) == 20);
+	REQUIRE(pool.capacity() == 20);
+	pool.deallocate_n(batch);
+	batch.clear();
+	REQUIRE(pool.allocate_n(20, std::back_inserter(batch)) == 20);
+}
+
+TEST_CASE("object_pool bulk borrow and return is thread safe", "[object_pool][bulk][thread_safety]") {
+	genesis::object_pool<uint64_t> pool{64};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> workers{};
+	for (std::size_t t = 0; t < 4; ++t) {
+		workers.emplace_back([&pool, &failures, t] {
+			std::vector<genesis::pool_ptr<uint64_t>> batch{};
+			for (std::size_t i = 0; i < 2000; ++i) {
+				batch.clear();
+				pool.allocate_n(16, std::back_inserter(batch));
+				for (auto& o : batch) { *o = t; }
+				for (auto& o : batch) {
+					if (*o != t) { ++failures; }
+				}
+				pool.deallocate_n(batch);
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	REQUIRE(failures == 0);
+	std::vector<genesis::pool_ptr<uint64_t>> batch{};
+	REQUIRE(pool.allocate_n(64, std::back_inserter(batch)) == 64);
+}
+
+namespace {
+
+struct resettable {
+	std::vector<uint64_t> values{};
+	std::size_t resets{0};
+
+	void reset() {
+		values.clear();
+		++resets;
+	}
+};
+
+} // end namespace
+
+TEST_CASE("object_pool keeps returned objects as they are by default", "[object_pool][recycle]") {
+	genesis::object_pool<resettable> pool{1};
+	pool.try_allocate()->values.push_back(1);
+	auto obj = pool.try_allocate();
+	REQUIRE(obj->values.size() == 1);
+	REQUIRE(obj->resets == 0);
+}
+
+TEST_CASE("object_pool resets returned objects on return", "[object_pool][recycle]") {
+	genesis::object_pool_options opts{1};
+	opts.recycle = genesis::pool_recycle::reset_on_return;
+	genesis::object_pool<resettable> pool{opts};
+	auto obj = pool.try_allocate();
+	obj->values.push_back(1);
+	auto* raw = obj.get();
+	obj.reset();
+	REQUIRE(raw->values.empty());
+	REQUIRE(raw->resets == 1);
+	{
+		auto shared = pool.allocate();
+		REQUIRE(shared);
+		(*shared)->values.push_back(2);
+	}
+	REQUIRE(raw->values.empty());
+	REQUIRE(raw->resets == 2);
+}
+
+TEST_CASE("object_pool resets returned objects on the next borrow", "[object_pool][recycle]") {
+	genesis::object_pool_options opts{1};
+	opts.recycle = genesis::pool_recycle::reset_on_borrow;
+	std::size_t hooked = 0;
+	genesis::object_pool<std::vector<uint64_t>> pool{
+		opts,
+		[] { return std::vector<uint64_t>{}; },
+		[&hooked](std::vector<uint64_t>& v) { v.clear(); ++hooked; }
+	};
+	auto obj = pool.try_allocate();
+	obj->push_back(1);
+	auto* raw = obj.get();
+	obj.reset();
+	REQUIRE(raw->size() == 1);
+	obj = pool.try_allocate();
+	REQUIRE(obj->empty());
+	REQUIRE(hooked == 2);
+}
+
+TEST_CASE("object_pool reconstructs returned objects with the generator", "[object_pool][recycle]") {
+	genesis::object_pool_options opts{2};
+	opts.recycle = genesis::pool_recycle::reconstruct;
+	std::size_t generated = 0;
+	auto generator = [&generated] {
+		if (++generated == 4) { throw std::runtime_error{"generator failed"}; }
+		return std::vector<uint64_t>(generated, 0);
+	};
+	genesis::object_pool<std::vector<uint64_t>> pool{opts, generator};
+	auto obj = pool.try_allocate();
+	obj->push_back(1);
+	obj.reset();
+	obj = pool.try_allocate();
+	REQUIRE(obj->size() == 3);
+	// The generator throws on this return, the node is rebuilt once the freelist runs dry.
+	obj.reset();
+	auto other = pool.try_allocate();
+	REQUIRE(other);
+	obj = pool.try_allocate();
+	REQUIRE(obj);
+	REQUIRE(obj->size() == 5);
+	REQUIRE_FALSE(pool.try_allocate());
+}
+
+TEST_CASE("object_pool reset policies need a reset hook", "[object_pool][recycle]") {
+	genesis::object_pool_options opts{1};
+	opts.recycle = genesis::pool_recycle::reset_on_return;
+	REQUIRE_THROWS(genesis::object_pool<uint64_t>{opts});
+	REQUIRE_NOTHROW(genesis::object_pool<uint64_t>{opts, [] { return uint64_t{0}; }, [](uint64_t& v) { v = 0; }});
+}
+
+TEST_CASE("object_pool counts nothing unless statistics are switched on", "[object_pool][stats]") {
+	genesis::object_pool<uint64_t> pool{2};
+	auto obj = pool.try_allocate();
+	auto stats = pool.stats();
+	REQUIRE(stats.capacity == 2);
+	REQUIRE(stats.borrows == 0);
+	REQUIRE(stats.borrowed == 0);
+}
+
+TEST_CASE("object_pool single threaded policy is a plain stack", "[object_pool][concurrency]") {
+	genesis::object_pool_options opts{2};
+	opts.max_capacity = 4;
+	opts.chunk_size = 2;
+	opts.magazine_size = 8;
+	genesis::object_pool<uint64_t, genesis::pool_single_thread> pool{opts};
+	REQUIRE(pool.magazine_size() == 0);
+	std::vector<genesis::pool_ptr<uint64_t, genesis::pool_single_thread>> held{};
+	REQUIRE(pool.allocate_n(5, std::back_inserter(held)) == 4);
+	REQUIRE(pool.capacity() == 4);
+	// Nobody else can return an object, so an exhausted pool fails at once instead of waiting.
+	auto start = std::chrono::steady_clock::now();
+	REQUIRE_FALSE(pool.allocate_for(std::chrono::seconds{5}));
+	REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds{1});
+	auto* last = held.back().get();
+	held.pop_back();
+	REQUIRE(pool.try_allocate().get() == last);
+	pool.deallocate_n(held);
+	auto shared = pool.allocate();
+	REQUIRE(shared);
+	**shared = 7;
+}
+
+TEST_CASE("object_pool spsc policy hands objects from the returner back to the borrower", "[object_pool][concurrency][thread_safety]") {
+	constexpr std::size_t handoffs = 20000;
+	genesis::object_pool<uint64_t, genesis::pool_spsc> pool{4};
+	std::mutex mutex{};
+	std::deque<genesis::pool_ptr<uint64_t, genesis::pool_spsc>> queue{};
+	std::atomic<std::size_t> failures{0};
+	std::thread returner{[&] {
+		for (std::size_t received = 0; received < handoffs;) {
+			genesis::pool_ptr<uint64_t, genesis::pool_spsc> obj{};
+			{
+				std::scoped_lock lock{mutex};
+				if (!queue.empty()) {
+					obj = std::move(queue.front());
+					queue.pop_front();
+				}
+			}
+			if (!obj) {
+				std::this_thread::yield();
+				continue;
+			}
+			if (*obj != received) { failures.fetch_add(1); }
+			++received;
+		}
+	}};
+	for (std::size_t sent = 0; sent < handoffs; ++sent) {
+		auto obj = pool.allocate_unique_for(std::chrono::seconds{5});
+		if (!obj) {
+			failures.fetch_add(1);
+			break;
+		}
+		*obj = sent;
+		std::scoped_lock lock{mutex};
+		queue.push_back(std::move(obj));
+	}
+	returner.join();
+	REQUIRE(failures == 0);
+	REQUIRE(pool.capacity() == 4);
+}
+
+TEST_CASE("object_pool spsc policy wakes a waiting borrower", "[object_pool][concurrency]") {
+	genesis::object_pool<uint64_t, genesis::pool_spsc> pool{1};
+	auto obj = pool.try_allocate();
+	std::thread returner{[&obj] {
+		std::this_thread::sleep_for(std::chrono::milliseconds{20});
+		obj.reset();
+	}};
+	auto next = pool.allocate_unique_for(std::chrono::seconds{5});
+	returner.join();
+	REQUIRE(next);
+}
+
+TEST_CASE("object_pool fifo fairness hands returned objects to the oldest waiter", "[object_pool][fairness]") {
+	genesis::object_pool_options opts{1};
+	opts.fairness = genesis::pool_fairness::fifo;
+	genesis::object_pool<uint64_t> pool{opts};
+	auto held = pool.try_allocate();
+	std::atomic<int> order{0};
+	std::atomic<int> first{0};
+	std::atomic<int> second{0};
+	std::thread a{[&] {
+		auto obj = pool.allocate_unique_for(std::chrono::seconds{5});
+		first = obj ? ++order : -1;
+	}};
+	while (pool.waiters() < 1) { std::this_thread::yield(); }
+	std::thread b{[&] {
+		auto obj = pool.allocate_unique_for(std::chrono::seconds{5});
+		second = obj ? ++order : -1;
+	}};
+	while (pool.waiters() < 2) { std::this_thread::yield(); }
+	held.reset();
+	a.join();
+	b.join();
+	REQUIRE(first == 1);
+	REQUIRE(second == 2);
+}
+
+TEST_CASE("object_pool fifo fairness never starves a waiter", "[object_pool][fairness][thread_safety]") {
+	constexpr std::size_t thread_count = 8;
+	constexpr std::size_t borrows = 2000;
+	genesis::object_pool_options opts{2};
+	opts.fairness = genesis::pool_fairness::fifo;
+	opts.magazine_size = 4;
+	genesis::object_pool<uint64_t> pool{opts};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> threads{};
+	for (std::size_t t = 0; t < thread_count; ++t) {
+		threads.emplace_back([&pool, &failures] {
+			for (std::size_t i = 0; i < borrows; ++i) {
+				auto obj = pool.allocate_unique_for(std::chrono::seconds{5});
+				if (!obj) { failures.fetch_add(1); }
+			}
+		});
+	}
+	for (auto& t : threads) { t.join(); }
+	REQUIRE(failures == 0);
+	REQUIRE(pool.waiters() == 0);
+}
+
+TEST_CASE("object_pool fifo fairness lets waiters leave the line", "[object_pool][fairness]") {
+	genesis::object_pool_options opts{1};
+	opts.fairness = genesis::pool_fairness::fifo;
+	genesis::object_pool<uint64_t> pool{opts};
+	auto held = pool.try_allocate();
+	REQUIRE_FALSE(pool.allocate_unique_for(std::chrono::milliseconds{10}));
+	genesis::inplace_stop_source source{};
+	std::thread stopper{[&] {
+		while (pool.waiters() < 1) { std::this_thread::yield(); }
+		source.request_stop();
+	}};
+	REQUIRE_FALSE(pool.allocate(source.get_token()));
+	stopper.join();
+	REQUIRE(pool.waiters() == 0);
+	// Nobody is left in line, so the returned object is published as usual.
+	held.reset();
+	REQUIRE(pool.try_allocate());
+}
@@ -0,0 +1,97 @@
+// Counting is switched on for this file only, the pools here hold a type no other test uses so no
+// object_pool instantiation is shared with a translation unit that has it switched off.
+#define GENESIS_OBJECT_POOL_STATS 1
+#include "genesis/object_pool.hpp"
+#include "genesis/sharded_object_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct counted {
+	uint64_t value{0};
+};
+
+} // end namespace
+
+TEST_CASE("object_pool counts borrows and returns", "[object_pool][stats]") {
+	genesis::object_pool<counted> pool{4};
+	{
+		auto first = pool.try_allocate();
+		auto second = pool.allocate();
+		auto stats = pool.stats();
+		REQUIRE(stats.capacity == 4);
+		REQUIRE(stats.borrows == 2);
+		REQUIRE(stats.returns == 0);
+		REQUIRE(stats.borrowed == 2);
+	}
+	std::vector<genesis::pool_ptr<counted>> batch{};
+	REQUIRE(pool.allocate_n(4, std::back_inserter(batch)) == 4);
+	REQUIRE_FALSE(pool.try_allocate());
+	pool.deallocate_n(batch);
+	auto stats = pool.stats();
+	REQUIRE(stats.borrows == 6);
+	REQUIRE(stats.returns == 6);
+	REQUIRE(stats.borrowed == 0);
+	REQUIRE(stats.high_water == 4);
+	REQUIRE(stats.failures == 1);
+	REQUIRE(stats.waits == 0);
+}
+
+TEST_CASE("object_pool records waits in the histogram", "[object_pool][stats][wait]") {
+	genesis::object_pool<counted> pool{1};
+	auto held = pool.try_allocate();
+	REQUIRE_FALSE(pool.allocate_for(std::chrono::milliseconds{5}));
+	auto stats = pool.stats();
+	REQUIRE(stats.waits == 1);
+	REQUIRE(stats.failures == 1);
+	uint64_t recorded = 0;
+	for (std::size_t i = 0; i < genesis::object_pool_stats::wait_buckets; ++i) {
+		recorded += stats.wait_histogram[i];
+		if (stats.wait_histogram[i] != 0) {
+			REQUIRE(genesis::object_pool_stats::wait_bucket_bound(i) > std::chrono::milliseconds{5});
+		}
+	}
+	REQUIRE(recorded == 1);
+}
+
+TEST_CASE("object_pool counters add up across threads", "[object_pool][stats][thread_safety]") {
+	genesis::object_pool<counted> pool{8};
+	std::vector<std::thread> workers{};
+	for (std::size_t t = 0; t < 4; ++t) {
+		workers.emplace_back([&pool] {
+			for (std::size_t i = 0; i < 1000; ++i) {
+				auto o = pool.allocate_unique_for(std::chrono::seconds{10});
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	auto stats = pool.stats();
+	REQUIRE(stats.borrows == 4000);
+	REQUIRE(stats.returns == 4000);
+	REQUIRE(stats.borrowed == 0);
+	REQUIRE(stats.high_water <= 4);
+}
+
+TEST_CASE("sharded_object_pool adds up the counters of its shards", "[sharded_object_pool][stats]") {
+	genesis::sharded_object_pool<counted> pool{genesis::object_pool_options{4}, 2};
+	std::vector<genesis::pool_ptr<counted>> obj_holder{};
+	for (std::size_t i = 0; i < 4; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+	}
+	REQUIRE_FALSE(pool.try_allocate());
+	auto stats = pool.stats();
+	REQUIRE(stats.capacity == 4);
+	REQUIRE(stats.borrows == 4);
+	REQUIRE(stats.borrowed == 4);
+	REQUIRE(stats.failures == 1);
+}
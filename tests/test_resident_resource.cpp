@@ -0,0 +1,106 @@
+#include "genesis/resident_resource.hpp"
+#include "genesis/object_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <system_error>
+#include <vector>
+
+#if GENESIS_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// @brief Whether every page of the range is in RAM, always true where it can't be asked.
+bool resident(void* p, std::size_t size) {
+#if GENESIS_LINUX
+	auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	auto begin = reinterpret_cast<std::uintptr_t>(p) / page * page;
+	auto end = reinterpret_cast<std::uintptr_t>(p) + size;
+	std::vector<unsigned char> pages((end - begin + page - 1) / page);
+	if (::mincore(reinterpret_cast<void*>(begin), end - begin, pages.data()) != 0) { return false; }
+	for (auto flags : pages) {
+		if ((flags & 1) == 0) { return false; }
+	}
+#else
+	(void)p;
+	(void)size;
+#endif
+	return true;
+}
+
+} // end namespace
+
+TEST_CASE("resident_resource prefaults large allocations", "[resident_resource]") {
+	genesis::resident_resource resource{};
+	constexpr std::size_t size = std::size_t{1} << 20;
+	auto* p = resource.allocate(size, 64);
+	REQUIRE(reinterpret_cast<std::uintptr_t>(p) % genesis::details::system_page_size() == 0);
+	REQUIRE(resident(p, size));
+	REQUIRE(resource.stats().prefaulted_bytes >= size);
+	REQUIRE(resource.stats().locked_bytes == 0);
+	REQUIRE_FALSE(resource.error());
+	resource.deallocate(p, size, 64);
+}
+
+TEST_CASE("resident_resource prefaults small allocations in place", "[resident_resource]") {
+	genesis::resident_resource resource{};
+	auto* p = resource.allocate(24, 8);
+	REQUIRE(resident(p, 24));
+	REQUIRE(resource.stats().prefaulted_bytes == 24);
+	resource.deallocate(p, 24, 8);
+}
+
+TEST_CASE("resident_resource reports lock failures without throwing", "[resident_resource]") {
+	genesis::resident_resource_options opts{};
+	opts.lock = true;
+	genesis::resident_resource resource{opts};
+	constexpr std::size_t size = std::size_t{64} << 10;
+	void* p = nullptr;
+	REQUIRE_NOTHROW(p = resource.allocate(size, 16));
+	auto stats = resource.stats();
+	// Whether mlock succeeds depends on RLIMIT_MEMLOCK, either way it is accounted for.
+	if (resource.error()) {
+		REQUIRE(stats.failures >= 1);
+		REQUIRE(stats.locked_bytes == 0);
+	} else {
+		REQUIRE(stats.failures == 0);
+		REQUIRE(stats.locked_bytes == size);
+	}
+	std::memset(p, 1, size);
+	REQUIRE_NOTHROW(resource.deallocate(p, size, 16));
+	resource.clear_error();
+	REQUIRE_FALSE(resource.error());
+}
+
+TEST_CASE("prefault_pages and lock_pages report through error_code", "[resident_resource]") {
+	std::error_code ec{};
+	std::vector<std::byte> buffer(10000);
+	REQUIRE(genesis::prefault_pages(buffer.data(), buffer.size(), ec));
+	REQUIRE_FALSE(ec);
+	REQUIRE(genesis::prefault_pages(nullptr, 0, ec));
+	// Whether the lock is granted depends on RLIMIT_MEMLOCK, a refusal must come back as a system error.
+	if (genesis::lock_pages(buffer.data(), buffer.size(), ec)) {
+		REQUIRE_FALSE(ec);
+		REQUIRE(genesis::unlock_pages(buffer.data(), buffer.size(), ec));
+		REQUIRE_FALSE(ec);
+	} else {
+		REQUIRE(ec);
+		REQUIRE(ec.category() == std::system_category());
+	}
+}
+
+TEST_CASE("object_pool on resident_resource is resident after construction", "[resident_resource]") {
+	genesis::resident_resource resource{};
+	struct node { std::byte payload[256]; };
+	genesis::object_pool<node> pool{genesis::object_pool_options{1024}, &resource};
+	REQUIRE(resource.stats().prefaulted_bytes >= 1024 * sizeof(node));
+	auto p = pool.try_allocate();
+	REQUIRE(p);
+	REQUIRE(resident(p.get(), sizeof(node)));
+}
@@ -0,0 +1,171 @@
+#include "genesis/sharded_object_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("sharded_object_pool splits the capacity over its shards", "[sharded_object_pool]") {
+	genesis::sharded_object_pool<uint64_t> pool{genesis::object_pool_options{10}, 4};
+	REQUIRE(pool.shard_count() == 4);
+	REQUIRE(pool.capacity() == 10);
+	REQUIRE(pool.max_capacity() == 10);
+	REQUIRE_THROWS(genesis::sharded_object_pool<uint64_t>{genesis::object_pool_options{10}, 0});
+}
+
+TEST_CASE("sharded_object_pool steals from other shards once the local one is empty", "[sharded_object_pool]") {
+	genesis::sharded_object_pool<uint64_t> pool{genesis::object_pool_options{16}, 4, [] { return uint64_t{3}; }};
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < 16; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+		REQUIRE(*obj_holder.back() == 3);
+	}
+	REQUIRE_FALSE(pool.try_allocate());
+	REQUIRE_FALSE(pool.allocate());
+	obj_holder.clear();
+	std::vector<std::shared_ptr<uint64_t>> shared_holder{};
+	for (std::size_t i = 0; i < 16; ++i) {
+		auto o = pool.allocate();
+		REQUIRE(o);
+		shared_holder.emplace_back(std::move(*o));
+	}
+	REQUIRE_FALSE(pool.try_allocate());
+}
+
+TEST_CASE("sharded_object_pool steals a batch at once without magazines", "[sharded_object_pool]") {
+	genesis::sharded_object_pool<uint64_t> pool{genesis::object_pool_options{32}, 2};
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	// The first 16 borrows empty the local shard without a steal.
+	for (std::size_t i = 0; i < 16; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+	REQUIRE(pool.stashed() == 0);
+	obj_holder.emplace_back(pool.try_allocate());
+	REQUIRE(obj_holder.back());
+	// One object was handed out, the rest of the batch waits for the next borrows.
+	REQUIRE(pool.stashed() == 7);
+	for (std::size_t i = 0; i < 7; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+	REQUIRE(pool.stashed() == 0);
+	// Stolen objects go back to the shard they belong to, so the local shard runs dry after 16 borrows again.
+	obj_holder.clear();
+	for (std::size_t i = 0; i < 16; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+	REQUIRE(pool.stashed() == 0);
+	obj_holder.emplace_back(pool.try_allocate());
+	REQUIRE(pool.stashed() == 7);
+}
+
+TEST_CASE("sharded_object_pool returns objects to their owning shard", "[sharded_object_pool]") {
+	genesis::sharded_object_pool<uint64_t> pool{genesis::object_pool_options{16}, 2};
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < 16; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+	}
+	REQUIRE(pool.stashed() == 0);
+	// Objects returned from another thread still land on the freelist of the shard they came from, so the
+	// local shard hands out its own 8 before a borrow has to steal again.
+	std::thread{[&obj_holder] { obj_holder.clear(); }}.join();
+	for (std::size_t i = 0; i < 8; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+	REQUIRE(pool.stashed() == 0);
+	obj_holder.emplace_back(pool.try_allocate());
+	REQUIRE(obj_holder.back());
+	REQUIRE(pool.stashed() == 7);
+}
+
+TEST_CASE("sharded_object_pool grows elastic shards", "[sharded_object_pool][elastic]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 4;
+	opts.max_capacity = 16;
+	opts.chunk_size = 4;
+	genesis::sharded_object_pool<uint64_t> pool{opts, 2};
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	for (std::size_t i = 0; i < 16; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+	}
+	REQUIRE(pool.capacity() == 16);
+	REQUIRE_FALSE(pool.try_allocate());
+}
+
+TEST_CASE("sharded_object_pool wakes a waiter when another shard gets an object back", "[sharded_object_pool][wait][thread_safety]") {
+	genesis::sharded_object_pool<uint64_t> pool{genesis::object_pool_options{2}, 2};
+	auto first = pool.try_allocate();
+	auto second = pool.try_allocate();
+	REQUIRE(first);
+	REQUIRE(second);
+	std::atomic<bool> borrowed{false};
+	auto waiter = std::thread{[&pool, &borrowed] {
+		borrowed = static_cast<bool>(pool.allocate_unique_for(std::chrono::seconds{10}));
+	}};
+	std::this_thread::sleep_for(std::chrono::milliseconds{5});
+	first.reset();
+	waiter.join();
+	REQUIRE(borrowed);
+}
+
+TEST_CASE("sharded_object_pool wakes a waiter without a deadline on a return to any shard", "[sharded_object_pool][wait][thread_safety]") {
+	genesis::sharded_object_pool<uint64_t> pool{genesis::object_pool_options{2}, 2};
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	obj_holder.emplace_back(pool.try_allocate());
+	obj_holder.emplace_back(pool.try_allocate());
+	REQUIRE(obj_holder[0]);
+	REQUIRE(obj_holder[1]);
+	genesis::inplace_stop_source source{};
+	std::atomic<bool> borrowed{false};
+	auto waiter = std::thread{[&pool, &borrowed, token = source.get_token()] {
+		borrowed = static_cast<bool>(pool.allocate_unique(token));
+	}};
+	std::this_thread::sleep_for(std::chrono::milliseconds{5});
+	// Return the objects in turn, whichever shard they belong to the waiter gets one.
+	for (auto& o : obj_holder) {
+		o.reset();
+		std::this_thread::sleep_for(std::chrono::milliseconds{5});
+	}
+	source.request_stop();
+	waiter.join();
+	REQUIRE(borrowed);
+}
+
+TEST_CASE("sharded_object_pool is thread safe", "[sharded_object_pool][thread_safety]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 32;
+	opts.magazine_size = 4;
+	genesis::sharded_object_pool<uint64_t> pool{opts, 4};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> workers{};
+	for (std::size_t t = 0; t < 8; ++t) {
+		workers.emplace_back([&pool, &failures, t] {
+			for (std::size_t i = 0; i < 5000; ++i) {
+				genesis::pool_ptr<uint64_t> objs[3];
+				for (auto& o : objs) {
+					o = pool.allocate_unique();
+					if (!o) { ++failures; continue; }
+					*o = t;
+				}
+				for (auto& o : objs) {
+					if (o && *o != t) { ++failures; }
+				}
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	REQUIRE(failures == 0);
+	REQUIRE(pool.capacity() == 32);
+}
@@ -0,0 +1,216 @@
+#include "genesis/small_vector.hpp"
+#include "genesis/arena_resource.hpp"
+
+#include "counting_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using genesis::tests::counting_resource;
+
+/// @brief Counts live objects and throws from its copy constructor on request.
+struct tracked {
+	static inline int live = 0;
+	static inline int throw_after = -1;
+	int value;
+
+	tracked(int init_value) : value{init_value} { ++live; }
+
+	tracked(const tracked& other) : value{other.value} {
+		if (throw_after == 0) { throw std::runtime_error{"copy"}; }
+		--throw_after;
+		++live;
+	}
+
+	tracked& operator=(const tracked&) = default;
+
+	~tracked() { --live; }
+};
+
+/// @brief Move-only element whose move constructor may throw, counts live objects and throws on request.
+struct move_only {
+	static inline int live = 0;
+	static inline int throw_after = -1;
+	int value;
+
+	move_only(int init_value) : value{init_value} { ++live; }
+
+	move_only(move_only&& other) : value{other.value} {
+		if (throw_after == 0) { throw std::runtime_error{"move"}; }
+		--throw_after;
+		++live;
+	}
+
+	move_only(const move_only&) = delete;
+
+	move_only& operator=(move_only&& other) {
+		value = other.value;
+		return *this;
+	}
+
+	move_only& operator=(const move_only&) = delete;
+
+	~move_only() { --live; }
+};
+
+} // end namespace
+
+TEST_CASE("small_vector stays inline up to N elements", "[small_vector]") {
+	counting_resource resource{};
+	genesis::pmr::small_vector<int, 8> v{&resource};
+	for (int i = 0; i < 8; ++i) { v.push_back(i); }
+	REQUIRE(v.is_inline());
+	REQUIRE(v.size() == 8);
+	REQUIRE(v.capacity() == 8);
+	REQUIRE(resource.allocations == 0);
+	v.push_back(8);
+	REQUIRE_FALSE(v.is_inline());
+	REQUIRE(resource.allocations == 1);
+	for (int i = 0; i < 9; ++i) { REQUIRE(v[i] == i); }
+	v.clear();
+	v.shrink_to_fit();
+	REQUIRE(v.is_inline());
+	REQUIRE(resource.outstanding == 0);
+}
+
+TEST_CASE("small_vector keeps sizeof small with std::allocator", "[small_vector]") {
+	STATIC_REQUIRE(sizeof(genesis::small_vector<int, 8>) == 3 * sizeof(void*) + 8 * sizeof(int));
+	STATIC_REQUIRE(sizeof(genesis::small_vector<char, 0>) <= 4 * sizeof(void*));
+}
+
+TEST_CASE("small_vector grows with non trivial elements", "[small_vector]") {
+	genesis::small_vector<std::string, 2> v{};
+	for (int i = 0; i < 100; ++i) { v.emplace_back(std::to_string(i) + std::string(30, 'x')); }
+	REQUIRE(v.size() == 100);
+	REQUIRE(v[57] == "57" + std::string(30, 'x'));
+	v.push_back(v[0]);
+	REQUIRE(v.back() == v.front());
+	v.erase(v.begin(), v.begin() + 50);
+	REQUIRE(v.size() == 51);
+	REQUIRE(v.front() == "50" + std::string(30, 'x'));
+	v.resize(3);
+	REQUIRE(v.size() == 3);
+	v.shrink_to_fit();
+	REQUIRE(v.capacity() == 3);
+	v.resize(1);
+	v.shrink_to_fit();
+	REQUIRE(v.is_inline());
+	REQUIRE(v[0] == "50" + std::string(30, 'x'));
+}
+
+TEST_CASE("small_vector insert and emplace in the middle", "[small_vector]") {
+	genesis::small_vector<int, 4> v{1, 2, 4};
+	v.insert(v.begin() + 2, 3);
+	REQUIRE(v == genesis::small_vector<int, 4>{1, 2, 3, 4});
+	v.emplace(v.begin(), 0);
+	REQUIRE(v == genesis::small_vector<int, 4>{0, 1, 2, 3, 4});
+	v.insert(v.begin() + 1, 3, v[4]);
+	REQUIRE(v == genesis::small_vector<int, 4>{0, 4, 4, 4, 1, 2, 3, 4});
+	std::list<int> extra{7, 8};
+	v.insert(v.end() - 1, extra.begin(), extra.end());
+	REQUIRE(v == genesis::small_vector<int, 4>{0, 4, 4, 4, 1, 2, 3, 7, 8, 4});
+	v.erase(v.begin() + 1);
+	REQUIRE(v.size() == 9);
+	v.pop_back();
+	REQUIRE(v.back() == 8);
+	REQUIRE_THROWS_AS(v.at(100), std::out_of_range);
+}
+
+TEST_CASE("small_vector copy, move and swap", "[small_vector]") {
+	genesis::small_vector<std::string, 2> small{"a", "b"};
+	genesis::small_vector<std::string, 2> big{"c", "d", "e"};
+	auto copy = big;
+	REQUIRE(copy == big);
+	auto moved_small = std::move(small);
+	REQUIRE(moved_small.size() == 2);
+	REQUIRE(small.empty());
+	const auto* heap = big.data();
+	auto moved_big = std::move(big);
+	REQUIRE(moved_big.data() == heap);
+	REQUIRE(big.empty());
+	REQUIRE(big.is_inline());
+	swap(moved_small, moved_big);
+	REQUIRE(moved_small == genesis::small_vector<std::string, 2>{"c", "d", "e"});
+	REQUIRE(moved_big == genesis::small_vector<std::string, 2>{"a", "b"});
+	REQUIRE(moved_big.is_inline());
+	genesis::small_vector<std::string, 2> other{"x"};
+	swap(moved_big, other);
+	REQUIRE(other.size() == 2);
+	REQUIRE(moved_big.front() == "x");
+	other = moved_small;
+	REQUIRE(other == moved_small);
+	other = {"z"};
+	REQUIRE(other.size() == 1);
+	REQUIRE_FALSE(other < moved_small);
+}
+
+TEST_CASE("pmr small_vector uses its resource and copies onto the default one", "[small_vector]") {
+	genesis::inline_arena_resource<1024> arena{};
+	genesis::pmr::small_vector<int, 2> v{&arena};
+	v.assign(10, 7);
+	REQUIRE(v.get_allocator().resource() == &arena);
+	genesis::pmr::small_vector<int, 2> copy{v};
+	REQUIRE(copy.get_allocator().resource() == std::pmr::get_default_resource());
+	genesis::pmr::small_vector<int, 2> moved{std::move(v), std::pmr::polymorphic_allocator<int>{}};
+	REQUIRE(moved == copy);
+	REQUIRE(v.empty());
+}
+
+TEST_CASE("small_vector relocates trivially relocatable elements on growth", "[small_vector]") {
+	genesis::small_vector<std::unique_ptr<int>, 1> v{};
+	for (int i = 0; i < 20; ++i) { v.push_back(std::make_unique<int>(i)); }
+	for (int i = 0; i < 20; ++i) { REQUIRE(*v[i] == i); }
+}
+
+TEST_CASE("small_vector keeps its elements when a copying growth throws", "[small_vector]") {
+	tracked::live = 0;
+	{
+		genesis::small_vector<tracked, 2> v{};
+		v.emplace_back(1);
+		v.emplace_back(2);
+		tracked::throw_after = 1;
+		REQUIRE_THROWS_AS(v.emplace_back(3), std::runtime_error);
+		tracked::throw_after = -1;
+		REQUIRE(v.size() == 2);
+		REQUIRE(v[0].value == 1);
+		REQUIRE(v[1].value == 2);
+		REQUIRE(tracked::live == 2);
+	}
+	REQUIRE(tracked::live == 0);
+}
+
+TEST_CASE("small_vector moves move-only elements whose move may throw", "[small_vector]") {
+	move_only::live = 0;
+	{
+		genesis::small_vector<move_only, 2> v{};
+		for (int i = 0; i < 8; ++i) { v.emplace_back(i); }
+		v.emplace(v.begin() + 4, 100);
+		REQUIRE(v.size() == 9);
+		REQUIRE(v[4].value == 100);
+		REQUIRE(v[8].value == 7);
+		while (v.size() > 2) { v.pop_back(); }
+		v.shrink_to_fit();
+		REQUIRE(v.is_inline());
+		REQUIRE(v[1].value == 1);
+		genesis::small_vector<move_only, 2> other{};
+		other.emplace_back(9);
+		swap(v, other);
+		REQUIRE(v.size() == 1);
+		REQUIRE(other[0].value == 0);
+		move_only::throw_after = 1;
+		REQUIRE_THROWS_AS(other.emplace_back(2), std::runtime_error);
+		move_only::throw_after = -1;
+		REQUIRE(other.size() == 2);
+		REQUIRE(move_only::live == 3);
+	}
+	REQUIRE(move_only::live == 0);
+}
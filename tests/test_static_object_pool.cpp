@@ -0,0 +1,166 @@
+#include "genesis/static_object_pool.hpp"
+
+#include "counting_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using genesis::tests::counting_resource;
+
+genesis::static_object_pool<uint64_t, 4> global_pool{[] { return uint64_t{9}; }};
+
+/// @brief Swaps the default memory resource for another one while in scope.
+struct default_resource_scope {
+	std::pmr::memory_resource* previous_;
+
+	explicit default_resource_scope(std::pmr::memory_resource* resource) :
+		previous_{std::pmr::set_default_resource(resource)}
+	{ }
+
+	~default_resource_scope() { std::pmr::set_default_resource(previous_); }
+};
+
+/// @brief A capture too large for the small buffer of a std::function, which remembers where its latest copy lives.
+struct located_seed {
+	static inline const void* last = nullptr;
+	std::array<uint64_t, 3> values;
+
+	explicit located_seed(uint64_t value) noexcept : values{value, 0, 0} { last = this; }
+
+	located_seed(const located_seed& other) noexcept : values{other.values} { last = this; }
+
+	located_seed(located_seed&& other) noexcept : values{other.values} { last = this; }
+};
+
+} // end namespace
+
+TEST_CASE("static_object_pool works as a global", "[static_object_pool]") {
+	REQUIRE(global_pool.capacity() == 4);
+	REQUIRE(global_pool.max_capacity() == 4);
+	auto obj = global_pool.try_allocate();
+	REQUIRE(obj);
+	REQUIRE(*obj == 9);
+}
+
+TEST_CASE("static_object_pool borrows and returns without a memory resource", "[static_object_pool]") {
+	default_resource_scope guard{std::pmr::null_memory_resource()};
+	genesis::static_object_pool<uint64_t, 8> pool{};
+	std::vector<genesis::pool_ptr<uint64_t>> obj_holder{};
+	obj_holder.reserve(8);
+	for (std::size_t i = 0; i < 8; ++i) {
+		obj_holder.emplace_back(pool.try_allocate());
+		REQUIRE(obj_holder.back());
+		*obj_holder.back() = i;
+	}
+	REQUIRE_FALSE(pool.try_allocate());
+	obj_holder.pop_back();
+	{
+		auto shared = pool.allocate();
+		REQUIRE(shared);
+		REQUIRE_FALSE(pool.try_allocate());
+	}
+	REQUIRE(pool.try_allocate());
+}
+
+TEST_CASE("static_object_pool keeps its callables in its own storage", "[static_object_pool]") {
+	counting_resource resource{};
+	default_resource_scope guard{&resource};
+	genesis::object_pool_options opts{};
+	opts.recycle = genesis::pool_recycle::reset_on_return;
+	located_seed seed{7};
+	genesis::static_object_pool<uint64_t, 4> pool{opts, [seed] { return seed.values[0]; }, [](uint64_t& v) { v = 8; }};
+	// The generator's capture was copied into the pool itself rather than into a heap block.
+	auto* begin = reinterpret_cast<const std::byte*>(&pool);
+	auto* stored = static_cast<const std::byte*>(located_seed::last);
+	REQUIRE(stored >= begin);
+	REQUIRE(stored < begin + sizeof(pool));
+	auto unique = pool.try_allocate();
+	auto shared = pool.allocate();
+	REQUIRE(unique);
+	REQUIRE(shared);
+	REQUIRE(*unique == 7);
+	unique.reset();
+	shared.reset();
+	unique = pool.try_allocate();
+	REQUIRE(*unique == 8);
+	REQUIRE(resource.allocations == 0);
+}
+
+TEST_CASE("static_object_pool keeps its nodes inline", "[static_object_pool]") {
+	genesis::static_object_pool<uint64_t, 2> pool{};
+	auto obj = pool.try_allocate();
+	auto* begin = reinterpret_cast<const std::byte*>(&pool);
+	auto* object = reinterpret_cast<const std::byte*>(obj.get());
+	REQUIRE(object >= begin);
+	REQUIRE(object < begin + sizeof(pool));
+}
+
+TEST_CASE("static_object_pool honours the construction and recycle options", "[static_object_pool]") {
+	genesis::object_pool_options opts{};
+	opts.capacity = 1000;
+	opts.magazine_size = 16;
+	opts.construction = genesis::pool_construction::lazy;
+	opts.recycle = genesis::pool_recycle::reset_on_return;
+	std::size_t generated = 0;
+	genesis::static_object_pool<uint64_t, 3> pool{opts, [&generated] { return ++generated; }, [](uint64_t& v) { v = 0; }};
+	REQUIRE(pool.capacity() == 3);
+	REQUIRE(pool.magazine_size() == 0);
+	REQUIRE(generated == 0);
+	auto obj = pool.try_allocate();
+	REQUIRE(*obj == 1);
+	obj.reset();
+	obj = pool.try_allocate();
+	REQUIRE(*obj == 0);
+	REQUIRE(generated == 1);
+}
+
+TEST_CASE("static_object_pool is thread safe", "[static_object_pool][thread_safety]") {
+	genesis::static_object_pool<uint64_t, 16> pool{};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> workers{};
+	for (std::size_t t = 0; t < 4; ++t) {
+		workers.emplace_back([&pool, &failures, t] {
+			for (std::size_t i = 0; i < 5000; ++i) {
+				genesis::pool_ptr<uint64_t> objs[2];
+				for (auto& o : objs) {
+					o = pool.allocate_unique();
+					if (!o) { ++failures; continue; }
+					*o = t;
+				}
+				for (auto& o : objs) {
+					if (o && *o != t) { ++failures; }
+				}
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	REQUIRE(failures == 0);
+}
+
+TEST_CASE("static_object_pool takes a concurrency policy", "[static_object_pool][concurrency]") {
+	genesis::static_object_pool<uint64_t, 2, genesis::pool_spsc> spsc{};
+	auto a = spsc.try_allocate();
+	auto b = spsc.try_allocate();
+	REQUIRE_FALSE(spsc.try_allocate());
+	std::thread returner{[&a] { a.reset(); }};
+	returner.join();
+	REQUIRE(spsc.allocate_unique_for(std::chrono::seconds{5}));
+
+	genesis::static_object_pool<uint64_t, 2, genesis::pool_single_thread> single{};
+	auto c = single.try_allocate();
+	c.reset();
+	REQUIRE(single.try_allocate());
+}
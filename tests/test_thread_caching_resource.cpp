@@ -0,0 +1,211 @@
+#include "genesis/thread_caching_resource.hpp"
+#include "genesis/object_pool.hpp"
+
+#include "counting_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using genesis::tests::counting_resource;
+
+} // end namespace
+
+TEST_CASE("thread_caching_resource reuses freed blocks", "[thread_caching_resource]") {
+	counting_resource upstream{};
+	genesis::thread_caching_resource resource{&upstream};
+	auto* a = resource.allocate(24, 8);
+	resource.deallocate(a, 24, 8);
+	auto* b = resource.allocate(20, 4);
+	REQUIRE(b == a);
+	resource.deallocate(b, 20, 4);
+	REQUIRE(upstream.allocations == 1);
+}
+
+TEST_CASE("thread_caching_resource hands out distinct aligned blocks", "[thread_caching_resource]") {
+	genesis::thread_caching_resource resource{};
+	std::set<void*> seen{};
+	std::vector<void*> blocks{};
+	for (std::size_t i = 0; i < 1000; ++i) {
+		auto* p = resource.allocate(48, 64);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+		REQUIRE(seen.insert(p).second);
+		std::memset(p, static_cast<int>(i), 48);
+		blocks.push_back(p);
+	}
+	for (auto* p : blocks) { resource.deallocate(p, 48, 64); }
+}
+
+TEST_CASE("thread_caching_resource passes large allocations upstream", "[thread_caching_resource]") {
+	counting_resource upstream{};
+	{
+		genesis::thread_caching_resource_options opts{};
+		opts.max_small = 1024;
+		genesis::thread_caching_resource resource{opts, &upstream};
+		REQUIRE(resource.max_small() == 1024);
+		auto* big = resource.allocate(4096, 16);
+		REQUIRE(upstream.outstanding == 1);
+		resource.deallocate(big, 4096, 16);
+		REQUIRE(upstream.outstanding == 0);
+		auto* overaligned = resource.allocate(16, 2048);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(overaligned) % 2048 == 0);
+		resource.deallocate(overaligned, 16, 2048);
+		REQUIRE(upstream.outstanding == 0);
+		auto* small = resource.allocate(16, 16);
+		resource.deallocate(small, 16, 16);
+		REQUIRE(upstream.outstanding == 1);
+	}
+	REQUIRE(upstream.outstanding == 0);
+}
+
+TEST_CASE("thread_caching_resource clamps an oversized largest size class", "[thread_caching_resource]") {
+	genesis::thread_caching_resource_options opts{};
+	opts.max_small = std::numeric_limits<std::size_t>::max();
+	genesis::thread_caching_resource resource{opts};
+	REQUIRE(resource.max_small() == std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 1));
+	auto* p = resource.allocate(100, 8);
+	resource.deallocate(p, 100, 8);
+}
+
+TEST_CASE("thread_caching_resource handles frees from other threads", "[thread_caching_resource]") {
+	counting_resource upstream{};
+	{
+		genesis::thread_caching_resource resource{&upstream};
+		std::mutex mutex{};
+		std::vector<void*> handoff{};
+		std::atomic<bool> done{false};
+		std::atomic<std::size_t> failures{0};
+		std::thread consumer{[&] {
+			std::size_t freed = 0;
+			while (true) {
+				auto finished = done.load();
+				std::vector<void*> batch{};
+				{
+					std::scoped_lock lock{mutex};
+					batch.swap(handoff);
+				}
+				for (auto* p : batch) {
+					if (*static_cast<std::uint64_t*>(p) != reinterpret_cast<std::uintptr_t>(p)) { ++failures; }
+					resource.deallocate(p, 32, 8);
+					++freed;
+				}
+				if (batch.empty() && finished) { break; }
+			}
+			if (freed != 20000) { ++failures; }
+		}};
+		std::vector<void*> allocated{};
+		for (std::size_t i = 0; i < 20000; ++i) {
+			auto* p = resource.allocate(32, 8);
+			*static_cast<std::uint64_t*>(p) = reinterpret_cast<std::uintptr_t>(p);
+			allocated.push_back(p);
+		}
+		for (auto* p : allocated) {
+			std::scoped_lock lock{mutex};
+			handoff.push_back(p);
+		}
+		done.store(true);
+		consumer.join();
+		REQUIRE(failures == 0);
+		// The consumer's cache went back to the central list when it exited, so blocks freed there are reused here.
+		auto before = upstream.allocations.load();
+		std::vector<void*> blocks{};
+		for (std::size_t i = 0; i < 20000; ++i) { blocks.push_back(resource.allocate(32, 8)); }
+		REQUIRE(upstream.allocations == before);
+		for (auto* p : blocks) { resource.deallocate(p, 32, 8); }
+	}
+	REQUIRE(upstream.outstanding == 0);
+}
+
+TEST_CASE("thread_caching_resource is safe under concurrent churn", "[thread_caching_resource]") {
+	genesis::thread_caching_resource resource{};
+	std::atomic<std::size_t> failures{0};
+	std::vector<std::thread> threads{};
+	for (std::size_t t = 0; t < 4; ++t) {
+		threads.emplace_back([&, t] {
+			std::vector<std::pair<std::uint64_t*, std::size_t>> live{};
+			for (std::size_t i = 0; i < 20000; ++i) {
+				auto size = std::size_t{8} << ((i + t) % 8);
+				auto* p = static_cast<std::uint64_t*>(resource.allocate(size, 8));
+				*p = t * 1000000 + i;
+				live.emplace_back(p, size);
+				if (live.size() > 64) {
+					for (std::size_t j = 0; j < 32; ++j) {
+						auto [q, q_size] = live.back();
+						live.pop_back();
+						auto value = *q;
+						if (value / 1000000 != t) { ++failures; }
+						resource.deallocate(q, q_size, 8);
+					}
+				}
+			}
+			for (auto [q, q_size] : live) { resource.deallocate(q, q_size, 8); }
+		});
+	}
+	for (auto& t : threads) { t.join(); }
+	REQUIRE(failures == 0);
+}
+
+TEST_CASE("thread_caching_resource shares freed batches under contention", "[thread_caching_resource]") {
+	counting_resource upstream{};
+	genesis::thread_caching_resource resource{&upstream};
+	std::vector<std::thread> threads{};
+	for (std::size_t t = 0; t < 4; ++t) {
+		threads.emplace_back([&resource] {
+			std::vector<void*> live(256);
+			for (std::size_t i = 0; i < 200; ++i) {
+				for (auto& p : live) { p = resource.allocate(64, 8); }
+				for (auto* p : live) { resource.deallocate(p, 64, 8); }
+			}
+		});
+	}
+	for (auto& t : threads) { t.join(); }
+	// At most 4 * (256 live + 64 cached) blocks are out at once, which fits in two 64 KiB spans. A borrower
+	// that found the central list empty while another thread was popping would carve more.
+	REQUIRE(upstream.allocations <= 2);
+}
+
+TEST_CASE("thread_caching_resource backs pmr containers and object_pool", "[thread_caching_resource]") {
+	genesis::thread_caching_resource resource{};
+	std::pmr::vector<std::pmr::string> strings{&resource};
+	for (int i = 0; i < 100; ++i) { strings.emplace_back(40, static_cast<char>('a' + i % 26)); }
+	REQUIRE(strings[27] == std::pmr::string(40, 'b'));
+	genesis::object_pool<int> pool{genesis::object_pool_options{8}, [] { return 7; }, &resource};
+	auto p = pool.try_allocate();
+	REQUIRE(p);
+	REQUIRE(*p == 7);
+}
+
+TEST_CASE("thread_caching_resource hands memory back on destruction", "[thread_caching_resource]") {
+	counting_resource upstream{};
+	{
+		genesis::thread_caching_resource resource{&upstream};
+		std::thread worker{[&] {
+			for (std::size_t i = 0; i < 1000; ++i) {
+				auto* p = resource.allocate(100, 8);
+				resource.deallocate(p, 100, 8);
+			}
+		}};
+		worker.join();
+		auto* p = resource.allocate(100, 8);
+		resource.deallocate(p, 100, 8);
+		REQUIRE(upstream.outstanding > 0);
+	}
+	REQUIRE(upstream.outstanding == 0);
+	// A new resource, possibly at the same address, starts with fresh caches.
+	genesis::thread_caching_resource again{&upstream};
+	auto* p = again.allocate(100, 8);
+	REQUIRE(upstream.outstanding == 1);
+	again.deallocate(p, 100, 8);
+}
@@ -0,0 +1,191 @@
+#include "genesis/variant.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace {
+
+/// @brief Counts live objects and throws from its constructor on request.
+struct tracked {
+	static inline int live = 0;
+	static inline bool throw_next = false;
+	int value;
+
+	tracked(int init_value) : value{init_value} {
+		if (throw_next) { throw std::runtime_error{"construct"}; }
+		++live;
+	}
+
+	tracked(const tracked& other) : value{other.value} { ++live; }
+
+	tracked& operator=(const tracked&) = default;
+
+	~tracked() { --live; }
+
+	friend bool operator==(const tracked& lhs, const tracked& rhs) { return lhs.value == rhs.value; }
+
+	friend bool operator<(const tracked& lhs, const tracked& rhs) { return lhs.value < rhs.value; }
+};
+
+template <std::size_t I>
+struct tag { std::size_t value = I; };
+
+template <std::size_t... Is>
+genesis::variant<tag<Is>...> make_wide(std::size_t index, std::index_sequence<Is...>) {
+	genesis::variant<tag<Is>...> v{};
+	((index == Is ? (v.template emplace<Is>(), 0) : 0), ...);
+	return v;
+}
+
+} // end namespace
+
+TEST_CASE("variant picks the smallest index type", "[variant]") {
+	STATIC_REQUIRE(sizeof(genesis::variant<char>) == 2);
+	STATIC_REQUIRE(sizeof(genesis::variant<uint32_t, float>) == 8);
+	STATIC_REQUIRE(sizeof(genesis::variant<uint64_t, double>) <= sizeof(std::variant<uint64_t, double>));
+	STATIC_REQUIRE(std::is_same_v<genesis::variant<int, float>::index_type, uint8_t>);
+	using wide = decltype(make_wide(0, std::make_index_sequence<300>{}));
+	STATIC_REQUIRE(std::is_same_v<wide::index_type, uint16_t>);
+}
+
+TEST_CASE("variant of trivially copyable alternatives is trivially copyable", "[variant]") {
+	STATIC_REQUIRE(std::is_trivially_copyable_v<genesis::variant<int, double>>);
+	STATIC_REQUIRE(std::is_trivially_destructible_v<genesis::variant<int, double>>);
+	STATIC_REQUIRE_FALSE(std::is_trivially_copyable_v<genesis::variant<int, std::string>>);
+	STATIC_REQUIRE_FALSE(std::is_copy_constructible_v<genesis::variant<int, std::unique_ptr<int>>>);
+	STATIC_REQUIRE(std::is_nothrow_move_constructible_v<genesis::variant<int, std::unique_ptr<int>>>);
+}
+
+TEST_CASE("variant construction, get and get_if", "[variant]") {
+	genesis::variant<int, std::string> v{};
+	REQUIRE(v.index() == 0);
+	REQUIRE(genesis::get<0>(v) == 0);
+	v = "hello";
+	REQUIRE(genesis::holds_alternative<std::string>(v));
+	REQUIRE(genesis::get<std::string>(v) == "hello");
+	REQUIRE(genesis::get_if<int>(&v) == nullptr);
+	REQUIRE_THROWS_AS(genesis::get<int>(v), std::bad_variant_access);
+	v = 42;
+	REQUIRE(*genesis::get_if<0>(&v) == 42);
+	genesis::variant<int, std::string> in_place{std::in_place_index<1>, 3u, 'x'};
+	REQUIRE(genesis::get<1>(in_place) == "xxx");
+	genesis::variant<int, std::string> by_type{std::in_place_type<std::string>, "abc"};
+	REQUIRE(by_type.index() == 1);
+	auto& s = by_type.emplace<std::string>("def");
+	REQUIRE(s == "def");
+	REQUIRE(genesis::get<std::string>(std::move(by_type)) == "def");
+}
+
+TEST_CASE("variant converting construction skips narrowing and bool conversions", "[variant]") {
+	genesis::variant<std::string, bool> text = "abc";
+	REQUIRE(text.index() == 0);
+	genesis::variant<std::string, bool> flag = true;
+	REQUIRE(flag.index() == 1);
+	genesis::variant<float, long> wide = 1;
+	REQUIRE(wide.index() == 1);
+	genesis::variant<float, int> from_double = 1.5f;
+	REQUIRE(from_double.index() == 0);
+	STATIC_REQUIRE_FALSE(std::is_constructible_v<genesis::variant<float, char>, int>);
+	STATIC_REQUIRE_FALSE(std::is_constructible_v<genesis::variant<bool>, int*>);
+}
+
+TEST_CASE("variant copy, move, assignment and swap", "[variant]") {
+	tracked::live = 0;
+	{
+		genesis::variant<tracked, std::string> a{tracked{1}};
+		genesis::variant<tracked, std::string> b{std::string{"b"}};
+		auto c = a;
+		REQUIRE(tracked::live == 2);
+		c = b;
+		REQUIRE(tracked::live == 1);
+		REQUIRE(genesis::get<std::string>(c) == "b");
+		c = std::move(a);
+		REQUIRE(genesis::get<tracked>(c).value == 1);
+		swap(b, c);
+		REQUIRE(genesis::get<tracked>(b).value == 1);
+		REQUIRE(genesis::get<std::string>(c) == "b");
+		b.swap(b);
+		REQUIRE(b == b);
+		REQUIRE(b != c);
+		REQUIRE(b < c);
+	}
+	REQUIRE(tracked::live == 0);
+	genesis::variant<int, std::unique_ptr<int>> owner{std::make_unique<int>(5)};
+	auto moved = std::move(owner);
+	REQUIRE(*genesis::get<1>(moved) == 5);
+}
+
+TEST_CASE("variant becomes valueless when emplace throws", "[variant]") {
+	tracked::live = 0;
+	genesis::variant<std::string, tracked> v{"text"};
+	tracked::throw_next = true;
+	REQUIRE_THROWS_AS(v.emplace<tracked>(1), std::runtime_error);
+	tracked::throw_next = false;
+	REQUIRE(v.valueless_by_exception());
+	REQUIRE(v.index() == genesis::variant_npos);
+	REQUIRE_THROWS_AS(genesis::visit([](auto&&) { }, v), std::bad_variant_access);
+	auto copy = v;
+	REQUIRE(copy.valueless_by_exception());
+	REQUIRE(copy == v);
+	v = tracked{2};
+	REQUIRE(genesis::get<tracked>(v).value == 2);
+	REQUIRE(tracked::live == 1);
+}
+
+TEST_CASE("variant of trivially copyable alternatives keeps its value when emplace throws", "[variant]") {
+	struct checked {
+		int value;
+		explicit checked(int init_value) : value{init_value} {
+			if (init_value < 0) { throw std::invalid_argument{"negative"}; }
+		}
+	};
+	genesis::variant<double, checked> v{1.5};
+	REQUIRE_THROWS_AS(v.emplace<checked>(-1), std::invalid_argument);
+	REQUIRE_FALSE(v.valueless_by_exception());
+	REQUIRE(genesis::get<double>(v) == 1.5);
+	v.emplace<checked>(3);
+	REQUIRE(genesis::get<checked>(v).value == 3);
+}
+
+TEST_CASE("variant visit dispatches to the active alternative", "[variant]") {
+	struct visitor {
+		int operator()(int i) const { return i; }
+		int operator()(double) const { return -1; }
+		int operator()(const std::string& s) const { return static_cast<int>(s.size()); }
+	};
+	genesis::variant<int, double, std::string> v{7};
+	REQUIRE(genesis::visit(visitor{}, v) == 7);
+	v = 2.5;
+	REQUIRE(v.visit(visitor{}) == -1);
+	v = std::string{"four"};
+	REQUIRE(genesis::visit(visitor{}, std::as_const(v)) == 4);
+	auto stolen = genesis::visit([](auto&& value) -> std::string {
+		if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>) { return std::move(value); }
+		return {};
+	}, std::move(v));
+	REQUIRE(stolen == "four");
+	genesis::variant<int, std::string> other{std::string{"ab"}};
+	genesis::variant<int, double, std::string> first{3};
+	auto sum = genesis::visit([](const auto& a, const auto& b) {
+		std::size_t total = 0;
+		if constexpr (std::is_same_v<std::decay_t<decltype(a)>, int>) { total += a; }
+		if constexpr (std::is_same_v<std::decay_t<decltype(b)>, std::string>) { total += b.size(); }
+		return total;
+	}, first, other);
+	REQUIRE(sum == 5);
+}
+
+TEST_CASE("variant visit uses the function table past 16 alternatives", "[variant]") {
+	for (std::size_t i : {0u, 15u, 16u, 99u}) {
+		auto v = make_wide(i, std::make_index_sequence<100>{});
+		REQUIRE(v.index() == i);
+		REQUIRE(genesis::visit([](auto t) { return t.value; }, v) == i);
+	}
+}